@@ -0,0 +1,233 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "../booksim.hpp"
+#include <iostream>
+#include <sstream>
+#include <cassert>
+
+#include "bitalloc.hpp"
+
+BitAllocator::BitAllocator( Module *parent, const string& name,
+			    int inputs, int outputs ) :
+  Allocator( parent, name, inputs, outputs ),
+  _out_words( _Words( outputs ) ), _in_words( _Words( inputs ) )
+{
+  _in_bits.resize(_inputs * _out_words, 0);
+  _out_bits.resize(_outputs * _in_words, 0);
+  _in_occ_bits.resize(_in_words, 0);
+  _out_occ_bits.resize(_out_words, 0);
+  _request.resize(_inputs * _outputs);
+}
+
+bool BitAllocator::_Any( word_t const * m, int words )
+{
+  for ( int w = 0; w < words; ++w ) {
+    if ( m[w] ) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int BitAllocator::_Count( word_t const * m, int words )
+{
+  int result = 0;
+  for ( int w = 0; w < words; ++w ) {
+    result += __builtin_popcountll( m[w] );
+  }
+  return result;
+}
+
+int BitAllocator::_RoundRobin( word_t const * a, word_t const * b,
+			       int words, int start )
+{
+  int const first = start >> 6;
+
+  word_t bits = a[first] & ( b ? b[first] : ~0ULL );
+  bits &= ~0ULL << ( start & 63 );
+  if ( bits ) {
+    return first * 64 + __builtin_ctzll( bits );
+  }
+  for ( int w = first + 1; w < words; ++w ) {
+    bits = a[w] & ( b ? b[w] : ~0ULL );
+    if ( bits ) {
+      return w * 64 + __builtin_ctzll( bits );
+    }
+  }
+  // wrap around; the part of the first word at or after start is known
+  // to be empty already
+  for ( int w = 0; w <= first; ++w ) {
+    bits = a[w] & ( b ? b[w] : ~0ULL );
+    if ( bits ) {
+      return w * 64 + __builtin_ctzll( bits );
+    }
+  }
+  return -1;
+}
+
+int BitAllocator::_Next( word_t const * m, int words, int i )
+{
+  ++i;
+  int w = i >> 6;
+  if ( w >= words ) {
+    return -1;
+  }
+  word_t bits = m[w] & ( ~0ULL << ( i & 63 ) );
+  while ( !bits ) {
+    if ( ++w >= words ) {
+      return -1;
+    }
+    bits = m[w];
+  }
+  return w * 64 + __builtin_ctzll( bits );
+}
+
+void BitAllocator::Clear( )
+{
+  for ( int in = _Next( &_in_occ_bits[0], _in_words, -1 ); in >= 0;
+	in = _Next( &_in_occ_bits[0], _in_words, in ) ) {
+    word_t * row = _InRow(in);
+    for ( int w = 0; w < _out_words; ++w ) {
+      row[w] = 0;
+    }
+  }
+  for ( int out = _Next( &_out_occ_bits[0], _out_words, -1 ); out >= 0;
+	out = _Next( &_out_occ_bits[0], _out_words, out ) ) {
+    word_t * row = _OutRow(out);
+    for ( int w = 0; w < _in_words; ++w ) {
+      row[w] = 0;
+    }
+  }
+  _in_occ_bits.assign(_in_words, 0);
+  _out_occ_bits.assign(_out_words, 0);
+
+  Allocator::Clear();
+}
+
+int BitAllocator::ReadRequest( int in, int out ) const
+{
+  assert( ( in >= 0 ) && ( in < _inputs ) );
+  assert( ( out >= 0 ) && ( out < _outputs ) );
+
+  return _Test( _InRow(in), out ) ? _Request(in, out).label : -1;
+}
+
+bool BitAllocator::ReadRequest( sRequest &req, int in, int out ) const
+{
+  assert( ( in >= 0 ) && ( in < _inputs ) );
+  assert( ( out >= 0 ) && ( out < _outputs ) );
+
+  if ( !_Test( _InRow(in), out ) ) {
+    return false;
+  }
+  req = _Request(in, out);
+  req.port = out;
+  return true;
+}
+
+void BitAllocator::AddRequest( int in, int out, int label,
+			       int in_pri, int out_pri )
+{
+  Allocator::AddRequest(in, out, label, in_pri, out_pri);
+  assert( !_Test( _InRow(in), out ) );
+
+  sRequest & req = _request[in * _outputs + out];
+  req.port    = out;
+  req.label   = label;
+  req.in_pri  = in_pri;
+  req.out_pri = out_pri;
+
+  _Set( _InRow(in), out );
+  _Set( _OutRow(out), in );
+  _Set( &_in_occ_bits[0], in );
+  _Set( &_out_occ_bits[0], out );
+}
+
+void BitAllocator::RemoveRequest( int in, int out, int label )
+{
+  assert( ( in >= 0 ) && ( in < _inputs ) );
+  assert( ( out >= 0 ) && ( out < _outputs ) );
+  assert( _Test( _InRow(in), out ) );
+  assert( _Request(in, out).label == label );
+
+  _Reset( _InRow(in), out );
+  if ( !_Any( _InRow(in), _out_words ) ) {
+    _Reset( &_in_occ_bits[0], in );
+  }
+  _Reset( _OutRow(out), in );
+  if ( !_Any( _OutRow(out), _in_words ) ) {
+    _Reset( &_out_occ_bits[0], out );
+  }
+}
+
+bool BitAllocator::InputHasRequests( int in ) const
+{
+  return _Test( &_in_occ_bits[0], in );
+}
+
+bool BitAllocator::OutputHasRequests( int out ) const
+{
+  return _Test( &_out_occ_bits[0], out );
+}
+
+int BitAllocator::NumInputRequests( int in ) const
+{
+  return _Count( _InRow(in), _out_words );
+}
+
+int BitAllocator::NumOutputRequests( int out ) const
+{
+  return _Count( _OutRow(out), _in_words );
+}
+
+void BitAllocator::PrintRequests( ostream * os ) const
+{
+  if(!os) os = &cout;
+
+  *os << "Input requests = [ ";
+  for ( int input = _Next( &_in_occ_bits[0], _in_words, -1 ); input >= 0;
+	input = _Next( &_in_occ_bits[0], _in_words, input ) ) {
+    *os << input << " -> [ ";
+    for ( int output = _Next( _InRow(input), _out_words, -1 ); output >= 0;
+	  output = _Next( _InRow(input), _out_words, output ) ) {
+      *os << output << "@" << _Request(input, output).in_pri << " ";
+    }
+    *os << "]  ";
+  }
+  *os << "], output requests = [ ";
+  for ( int output = _Next( &_out_occ_bits[0], _out_words, -1 ); output >= 0;
+	output = _Next( &_out_occ_bits[0], _out_words, output ) ) {
+    *os << output << " -> [ ";
+    for ( int input = _Next( _OutRow(output), _in_words, -1 ); input >= 0;
+	  input = _Next( _OutRow(output), _in_words, input ) ) {
+      *os << input << "@" << _Request(input, output).out_pri << " ";
+    }
+    *os << "]  ";
+  }
+  *os << "]." << endl;
+}
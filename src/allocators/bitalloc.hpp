@@ -0,0 +1,107 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*bitalloc.hpp
+ *
+ *Base class for the bit-parallel allocators. Requests are kept as one
+ *bit row per input (over outputs) and one per output (over inputs), so
+ *the grant and accept phases reduce to word-wide ANDs and a rotate +
+ *find-first-set round-robin. The payload of each request lives in a
+ *flat dense table that is only read for set bits; Clear() touches only
+ *the rows that were used and nothing is allocated after construction.
+ */
+
+#ifndef _BITALLOC_HPP_
+#define _BITALLOC_HPP_
+
+#include <vector>
+
+#include "allocator.hpp"
+
+class BitAllocator : public Allocator {
+protected:
+  typedef unsigned long long word_t;
+
+  // words per input row (bits over outputs) and per output row
+  const int _out_words;
+  const int _in_words;
+
+  vector<word_t> _in_bits;
+  vector<word_t> _out_bits;
+  vector<word_t> _in_occ_bits;
+  vector<word_t> _out_occ_bits;
+
+  vector<sRequest> _request;
+
+  word_t * _InRow( int in ) { return &_in_bits[in * _out_words]; }
+  word_t const * _InRow( int in ) const { return &_in_bits[in * _out_words]; }
+  word_t * _OutRow( int out ) { return &_out_bits[out * _in_words]; }
+  word_t const * _OutRow( int out ) const { return &_out_bits[out * _in_words]; }
+
+  sRequest const & _Request( int in, int out ) const { return _request[in * _outputs + out]; }
+
+  static int _Words( int bits ) { return ( bits + 63 ) / 64; }
+
+  static bool _Test( word_t const * m, int i ) {
+    return ( m[i >> 6] >> ( i & 63 ) ) & 1;
+  }
+  static void _Set( word_t * m, int i ) { m[i >> 6] |= 1ULL << ( i & 63 ); }
+  static void _Reset( word_t * m, int i ) { m[i >> 6] &= ~( 1ULL << ( i & 63 ) ); }
+  static bool _Any( word_t const * m, int words );
+  static int _Count( word_t const * m, int words );
+
+  // Lowest set bit of (a & b) at or after start, wrapping around; -1 if
+  // the intersection is empty. b may be NULL to use a alone.
+  static int _RoundRobin( word_t const * a, word_t const * b,
+                          int words, int start );
+
+  // Next set bit strictly after i, in ascending order; -1 at the end.
+  static int _Next( word_t const * m, int words, int i );
+
+public:
+  BitAllocator( Module *parent, const string& name,
+		int inputs, int outputs );
+
+  void Clear( );
+
+  int  ReadRequest( int in, int out ) const;
+  bool ReadRequest( sRequest &req, int in, int out ) const;
+
+  void AddRequest( int in, int out, int label = 1,
+		   int in_pri = 0, int out_pri = 0 );
+  void RemoveRequest( int in, int out, int label = 1 );
+
+  bool OutputHasRequests( int out ) const;
+  bool InputHasRequests( int in ) const;
+
+  int NumOutputRequests( int out ) const;
+  int NumInputRequests( int in ) const;
+
+  void PrintRequests( ostream * os = NULL ) const;
+};
+
+#endif
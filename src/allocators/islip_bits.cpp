@@ -0,0 +1,110 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "../booksim.hpp"
+
+#include "islip_bits.hpp"
+
+iSLIP_Bits::iSLIP_Bits( Module *parent, const string& name,
+			int inputs, int outputs, int iters ) :
+  BitAllocator( parent, name, inputs, outputs ), _iSLIP_iter( iters )
+{
+  _gptrs.resize(_outputs, 0);
+  _aptrs.resize(_inputs, 0);
+  _grants.resize(_inputs * _out_words, 0);
+  _granted_in.resize(_in_words, 0);
+  _free_in.resize(_in_words, 0);
+}
+
+void iSLIP_Bits::Allocate( )
+{
+  // only inputs that have requests can take part in a match
+  for ( int w = 0; w < _in_words; ++w ) {
+    _free_in[w] = _in_occ_bits[w];
+  }
+  for ( int input = _Next( &_in_occ_bits[0], _in_words, -1 ); input >= 0;
+	input = _Next( &_in_occ_bits[0], _in_words, input ) ) {
+    if ( _inmatch[input] != -1 ) {
+      _Reset( &_free_in[0], input );
+    }
+  }
+
+  for ( int iter = 0; iter < _iSLIP_iter; ++iter ) {
+
+    // Grant phase: each free output picks the first free requesting
+    // input at or after its pointer
+
+    bool granted = false;
+
+    for ( int output = _Next( &_out_occ_bits[0], _out_words, -1 ); output >= 0;
+	  output = _Next( &_out_occ_bits[0], _out_words, output ) ) {
+      if ( _outmatch[output] != -1 ) {
+	continue;
+      }
+      int const input = _RoundRobin( _OutRow(output), &_free_in[0],
+				     _in_words, _gptrs[output] );
+      if ( input >= 0 ) {
+	_Set( &_grants[input * _out_words], output );
+	_Set( &_granted_in[0], input );
+	granted = true;
+      }
+    }
+
+    // nothing can change in later iterations either
+    if ( !granted ) {
+      break;
+    }
+
+    // Accept phase: each granted input takes the first granting output
+    // at or after its pointer
+
+    for ( int input = _Next( &_granted_in[0], _in_words, -1 ); input >= 0;
+	  input = _Next( &_granted_in[0], _in_words, input ) ) {
+      word_t * const grants = &_grants[input * _out_words];
+      int const output = _RoundRobin( grants, 0, _out_words, _aptrs[input] );
+      assert( output >= 0 );
+
+      _inmatch[input] = output;
+      _outmatch[output] = input;
+      _Reset( &_free_in[0], input );
+
+      // Only update pointers if accepted during the 1st iteration
+      if ( iter == 0 ) {
+	_gptrs[output] = ( input + 1 ) % _inputs;
+	_aptrs[input] = ( output + 1 ) % _outputs;
+      }
+
+      for ( int w = 0; w < _out_words; ++w ) {
+	grants[w] = 0;
+      }
+    }
+
+    for ( int w = 0; w < _in_words; ++w ) {
+      _granted_in[w] = 0;
+    }
+  }
+}
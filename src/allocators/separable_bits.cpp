@@ -0,0 +1,169 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "../booksim.hpp"
+
+#include "separable_bits.hpp"
+
+SeparableBitAllocator::SeparableBitAllocator( Module* parent, const string& name,
+					      int inputs, int outputs,
+					      const string& arb_type )
+  : BitAllocator( parent, name, inputs, outputs )
+{
+  if ( ( arb_type != "round_robin" ) && ( arb_type != "round_robin_bits" ) ) {
+    Error( "Bit-parallel separable allocators only support round_robin arbiters, got: " + arb_type );
+  }
+  _in_ptrs.resize(_inputs, 0);
+  _out_ptrs.resize(_outputs, 0);
+  _best.resize(max(_in_words, _out_words), 0);
+}
+
+int SeparableBitAllocator::_PickOutput( int input, word_t const * outputs )
+{
+  int best_pri = 0;
+  bool first = true;
+  for ( int output = _Next( outputs, _out_words, -1 ); output >= 0;
+	output = _Next( outputs, _out_words, output ) ) {
+    int const pri = _Request(input, output).in_pri;
+    if ( first || ( pri > best_pri ) ) {
+      for ( int w = 0; w < _out_words; ++w ) {
+	_best[w] = 0;
+      }
+      best_pri = pri;
+      first = false;
+    }
+    if ( pri == best_pri ) {
+      _Set( &_best[0], output );
+    }
+  }
+  return _RoundRobin( &_best[0], 0, _out_words, _in_ptrs[input] );
+}
+
+int SeparableBitAllocator::_PickInput( int output, word_t const * inputs )
+{
+  int best_pri = 0;
+  bool first = true;
+  for ( int input = _Next( inputs, _in_words, -1 ); input >= 0;
+	input = _Next( inputs, _in_words, input ) ) {
+    int const pri = _Request(input, output).out_pri;
+    if ( first || ( pri > best_pri ) ) {
+      for ( int w = 0; w < _in_words; ++w ) {
+	_best[w] = 0;
+      }
+      best_pri = pri;
+      first = false;
+    }
+    if ( pri == best_pri ) {
+      _Set( &_best[0], input );
+    }
+  }
+  return _RoundRobin( &_best[0], 0, _in_words, _out_ptrs[output] );
+}
+
+void SeparableBitAllocator::_Match( int input, int output )
+{
+  assert( ( _inmatch[input] == -1 ) && ( _outmatch[output] == -1 ) );
+
+  _inmatch[input] = output;
+  _outmatch[output] = input;
+  _in_ptrs[input] = ( output + 1 ) % _outputs;
+  _out_ptrs[output] = ( input + 1 ) % _inputs;
+}
+
+SeparableInputFirstBits::SeparableInputFirstBits( Module* parent, const string& name,
+						  int inputs, int outputs,
+						  const string& arb_type )
+  : SeparableBitAllocator( parent, name, inputs, outputs, arb_type )
+{
+  _cand.resize(_outputs * _in_words, 0);
+  _cand_occ.resize(_out_words, 0);
+}
+
+void SeparableInputFirstBits::Allocate( )
+{
+  // input arbiters: each requesting input forwards one output request
+
+  for ( int input = _Next( &_in_occ_bits[0], _in_words, -1 ); input >= 0;
+	input = _Next( &_in_occ_bits[0], _in_words, input ) ) {
+    int const output = _PickOutput( input, _InRow(input) );
+    assert( output >= 0 );
+    _Set( &_cand[output * _in_words], input );
+    _Set( &_cand_occ[0], output );
+  }
+
+  // output arbiters
+
+  for ( int output = _Next( &_cand_occ[0], _out_words, -1 ); output >= 0;
+	output = _Next( &_cand_occ[0], _out_words, output ) ) {
+    word_t * const cand = &_cand[output * _in_words];
+    int const input = _PickInput( output, cand );
+    assert( input >= 0 );
+    _Match( input, output );
+    for ( int w = 0; w < _in_words; ++w ) {
+      cand[w] = 0;
+    }
+  }
+
+  _cand_occ.assign(_out_words, 0);
+}
+
+SeparableOutputFirstBits::SeparableOutputFirstBits( Module* parent, const string& name,
+						    int inputs, int outputs,
+						    const string& arb_type )
+  : SeparableBitAllocator( parent, name, inputs, outputs, arb_type )
+{
+  _cand.resize(_inputs * _out_words, 0);
+  _cand_occ.resize(_in_words, 0);
+}
+
+void SeparableOutputFirstBits::Allocate( )
+{
+  // output arbiters: each requested output forwards one input grant
+
+  for ( int output = _Next( &_out_occ_bits[0], _out_words, -1 ); output >= 0;
+	output = _Next( &_out_occ_bits[0], _out_words, output ) ) {
+    int const input = _PickInput( output, _OutRow(output) );
+    assert( input >= 0 );
+    _Set( &_cand[input * _out_words], output );
+    _Set( &_cand_occ[0], input );
+  }
+
+  // input arbiters
+
+  for ( int input = _Next( &_cand_occ[0], _in_words, -1 ); input >= 0;
+	input = _Next( &_cand_occ[0], _in_words, input ) ) {
+    word_t * const cand = &_cand[input * _out_words];
+    int const output = _PickOutput( input, cand );
+    assert( output >= 0 );
+    _Match( input, output );
+    for ( int w = 0; w < _out_words; ++w ) {
+      cand[w] = 0;
+    }
+  }
+
+  _cand_occ.assign(_in_words, 0);
+}
@@ -0,0 +1,94 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*separable_bits.hpp
+ *
+ *Separable input-first and output-first allocators on the bit-matrix
+ *request store. The per-port arbiters are round-robin arbiters folded
+ *into the allocator: the highest-priority requests are collected into a
+ *mask and the winner is the first of them at or after the pointer, which
+ *matches RoundRobinArbiter grant for grant.
+ */
+
+#ifndef _SEPARABLE_BITS_HPP_
+#define _SEPARABLE_BITS_HPP_
+
+#include <vector>
+
+#include "bitalloc.hpp"
+
+class SeparableBitAllocator : public BitAllocator {
+
+protected:
+
+  // round-robin pointers of the input (over outputs) and output (over
+  // inputs) arbiters
+  vector<int> _in_ptrs;
+  vector<int> _out_ptrs;
+
+  // candidates forwarded from the first arbitration stage, one row per
+  // second-stage port, and the ports that have any
+  vector<word_t> _cand;
+  vector<word_t> _cand_occ;
+
+  vector<word_t> _best;
+
+  int _PickOutput( int input, word_t const * outputs );
+  int _PickInput( int output, word_t const * inputs );
+
+  void _Match( int input, int output );
+
+public:
+
+  SeparableBitAllocator( Module* parent, const string& name, int inputs,
+			 int outputs, const string& arb_type );
+
+};
+
+class SeparableInputFirstBits : public SeparableBitAllocator {
+
+public:
+
+  SeparableInputFirstBits( Module* parent, const string& name, int inputs,
+			   int outputs, const string& arb_type );
+
+  void Allocate( );
+
+};
+
+class SeparableOutputFirstBits : public SeparableBitAllocator {
+
+public:
+
+  SeparableOutputFirstBits( Module* parent, const string& name, int inputs,
+			    int outputs, const string& arb_type );
+
+  void Allocate( );
+
+};
+
+#endif
@@ -0,0 +1,132 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "../booksim.hpp"
+
+#include <algorithm>
+#include <functional>
+
+#include "wavefront_bits.hpp"
+
+WavefrontBits::WavefrontBits( Module *parent, const string& name,
+			      int inputs, int outputs, bool skip_diags ) :
+  BitAllocator( parent, name, inputs, outputs ),
+  _last_in(-1), _last_out(-1), _skip_diags(skip_diags),
+  _square(max(inputs, outputs)), _pri(0), _num_requests(0)
+{
+  _free_out.resize(_out_words, 0);
+}
+
+void WavefrontBits::AddRequest( int in, int out, int label,
+				int in_pri, int out_pri )
+{
+  BitAllocator::AddRequest(in, out, label, in_pri, out_pri);
+  _num_requests++;
+  _last_in = in;
+  _last_out = out;
+  pair<int, int> const level(out_pri, in_pri);
+  if ( find(_priorities.begin(), _priorities.end(), level) == _priorities.end() ) {
+    _priorities.push_back(level);
+  }
+}
+
+void WavefrontBits::Allocate( )
+{
+
+  int first_diag = -1;
+
+  if(_num_requests == 0)
+
+    // bypass allocator completely if there were no requests
+    return;
+
+  if(_num_requests == 1) {
+
+    // if we only had a single request, we can immediately grant it
+    _inmatch[_last_in] = _last_out;
+    _outmatch[_last_out] = _last_in;
+    first_diag = _last_in + _last_out;
+
+  } else {
+
+    // highest (out_pri, in_pri) first, as in Wavefront's reverse set walk
+    sort(_priorities.begin(), _priorities.end(), greater<pair<int, int> >());
+    bool const check_pri = ( _priorities.size() > 1 );
+
+    for ( int w = 0; w < _out_words; ++w ) {
+      _free_out[w] = _out_occ_bits[w];
+    }
+    for ( int output = _Next( &_out_occ_bits[0], _out_words, -1 ); output >= 0;
+	  output = _Next( &_out_occ_bits[0], _out_words, output ) ) {
+      if ( _outmatch[output] != -1 ) {
+	_Reset( &_free_out[0], output );
+      }
+    }
+
+    for ( size_t level = 0; level < _priorities.size(); ++level ) {
+
+      int const out_pri = _priorities[level].first;
+      int const in_pri = _priorities[level].second;
+
+      // every (input, output) pair on a diagonal is distinct in both
+      // coordinates, so only matches from earlier diagonals can block
+      for ( int p = 0; p < _square; ++p ) {
+	if ( !_Any( &_free_out[0], _out_words ) ) {
+	  break;
+	}
+	int const diag = _pri + p;
+	for ( int output = _Next( &_free_out[0], _out_words, -1 ); output >= 0;
+	      output = _Next( &_free_out[0], _out_words, output ) ) {
+	  int const input = ( diag + ( _square - output ) ) % _square;
+	  if ( ( input < _inputs ) && ( _inmatch[input] == -1 ) &&
+	       _Test( _OutRow(output), input ) &&
+	       ( !check_pri ||
+		 ( ( _Request(input, output).in_pri == in_pri ) &&
+		   ( _Request(input, output).out_pri == out_pri ) ) ) ) {
+	    // Grant!
+	    _inmatch[input] = output;
+	    _outmatch[output] = input;
+	    _Reset( &_free_out[0], output );
+	    if(first_diag < 0) {
+	      first_diag = input + output;
+	    }
+	  }
+	}
+      }
+    }
+  }
+
+  _num_requests = 0;
+  _last_in = -1;
+  _last_out = -1;
+  _priorities.clear();
+
+  assert(first_diag >= 0);
+
+  // Round-robin the priority diagonal
+  _pri = ( ( _skip_diags ? first_diag : _pri ) + 1 ) % _square;
+}
@@ -0,0 +1,116 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*arbiter_bench.cpp
+ *
+ *Microbenchmark for the arbiters: each round clears the arbiter, posts a
+ *pre-generated set of requests (a few priority levels, varying density),
+ *arbitrates and updates the priority state, the way the separable
+ *allocators drive their per-port arbiters. The loop-based arbiters are
+ *timed against the mask-based ones, and the winners are checked to match.
+ *
+ *Build with "make bench" and run ./arbiters/arbiter_bench [rounds]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "arbiter.hpp"
+
+using namespace std;
+
+struct Round {
+  vector<int> inputs;
+  vector<int> pris;
+};
+
+static vector<Round> MakeRounds( int size, int count )
+{
+  vector<Round> rounds( count );
+  srand( 1 );
+  for ( int r = 0; r < count; ++r ) {
+    int const density = 1 + rand( ) % 100;
+    for ( int i = 0; i < size; ++i ) {
+      if ( rand( ) % 100 < density ) {
+	rounds[r].inputs.push_back( i );
+	rounds[r].pris.push_back( rand( ) % 2 );
+      }
+    }
+  }
+  return rounds;
+}
+
+static double TimeArbiter( const string & type, int size,
+			   const vector<Round> & rounds, int iterations,
+			   long & check )
+{
+  Arbiter * arb = Arbiter::NewArbiter( 0, "arb", type, size );
+  check = 0;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now( );
+  for ( int n = 0; n < iterations; ++n ) {
+    const Round & round = rounds[n % rounds.size( )];
+    arb->Clear( );
+    for ( size_t i = 0; i < round.inputs.size( ); ++i ) {
+      arb->AddRequest( round.inputs[i], i, round.pris[i] );
+    }
+    int const winner = arb->Arbitrate( );
+    arb->UpdateState( );
+    check = check * 31 + winner;
+  }
+  chrono::steady_clock::time_point stop = chrono::steady_clock::now( );
+  delete arb;
+  return iterations / chrono::duration<double>( stop - start ).count( );
+}
+
+int main( int argc, char ** argv )
+{
+  int iterations = ( argc > 1 ) ? atoi( argv[1] ) : 2000000;
+
+  const char * types[][2] = { { "round_robin", "round_robin_bits" },
+			      { "matrix", "matrix_bits" } };
+  int const sizes[] = { 5, 10, 16, 64, 80 };
+
+  for ( int t = 0; t < 2; ++t ) {
+    for ( int s = 0; s < 5; ++s ) {
+      vector<Round> rounds = MakeRounds( sizes[s], 4096 );
+      long before_check, after_check;
+      double before = TimeArbiter( types[t][0], sizes[s], rounds, iterations, before_check );
+      double after = TimeArbiter( types[t][1], sizes[s], rounds, iterations, after_check );
+      if ( before_check != after_check ) {
+	cerr << "Mismatch between " << types[t][0] << " and " << types[t][1]
+	     << " winners for " << sizes[s] << " inputs." << endl;
+	return 1;
+      }
+      cout << types[t][0] << " " << sizes[s] << " inputs: "
+	   << before / 1e6 << " M/s, " << types[t][1] << " "
+	   << after / 1e6 << " M/s" << endl;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,98 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// ----------------------------------------------------------------------
+//
+//  BitsArbiter: Base class for the mask-based arbiters
+//
+// ----------------------------------------------------------------------
+
+#include "bits_arb.hpp"
+
+#include <cassert>
+
+using namespace std ;
+
+BitsArbiter::BitsArbiter( Module *parent, const string &name, int size )
+  : Arbiter( parent, name, size ), _words( ( size + 63 ) / 64 ),
+    _mask( ( size >= 64 ) ? ~0ULL : ( ( 1ULL << size ) - 1 ) ) {
+  _req_bits.resize(_words, 0);
+}
+
+int BitsArbiter::_FirstFrom( word_t const * m, int start ) const
+{
+  assert( ( start >= 0 ) && ( start < _size ) );
+
+  if ( _words == 1 ) {
+    word_t const bits = m[0] ;
+    if ( !bits ) {
+      return -1 ;
+    }
+    // rotate the request mask so that start becomes bit 0
+    if ( !start ) {
+      return __builtin_ctzll( bits ) ;
+    }
+    word_t const rotated = ( bits >> start ) | ( bits << ( _size - start ) ) ;
+    int const input = __builtin_ctzll( rotated & _mask ) + start ;
+    return ( input < _size ) ? input : ( input - _size ) ;
+  }
+
+  int const first = start >> 6 ;
+  word_t bits = m[first] & ( ~0ULL << ( start & 63 ) ) ;
+  if ( bits ) {
+    return first * 64 + __builtin_ctzll( bits ) ;
+  }
+  for ( int w = first + 1 ; w < _words ; ++w ) {
+    if ( m[w] ) {
+      return w * 64 + __builtin_ctzll( m[w] ) ;
+    }
+  }
+  for ( int w = 0 ; w <= first ; ++w ) {
+    if ( m[w] ) {
+      return w * 64 + __builtin_ctzll( m[w] ) ;
+    }
+  }
+  return -1 ;
+}
+
+void BitsArbiter::Clear()
+{
+  if(_num_reqs > 0) {
+
+    // clear only the entries that were requested
+    for ( int w = 0 ; w < _words ; ++w ) {
+      word_t bits = _req_bits[w] ;
+      while ( bits ) {
+	_request[w * 64 + __builtin_ctzll( bits )].valid = false ;
+	bits &= bits - 1 ;
+      }
+      _req_bits[w] = 0 ;
+    }
+    _num_reqs = 0 ;
+    _selected = -1;
+  }
+}
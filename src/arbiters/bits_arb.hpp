@@ -0,0 +1,101 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// ----------------------------------------------------------------------
+//
+//  BitsArbiter: Base class for the mask-based arbiters
+//
+//  Valid requests are additionally kept as a bit mask over the inputs,
+//  so Clear() only touches the inputs that requested and the derived
+//  arbiters can pick a winner with count-trailing-zeros instead of a
+//  loop over every input.
+//
+// ----------------------------------------------------------------------
+
+#ifndef _BITS_ARB_HPP_
+#define _BITS_ARB_HPP_
+
+#include <vector>
+#include <cassert>
+
+#include "arbiter.hpp"
+
+class BitsArbiter : public Arbiter {
+
+protected:
+
+  typedef unsigned long long word_t ;
+
+  const int _words ;
+
+  // valid bits of a single-word mask
+  const word_t _mask ;
+
+  // inputs with a valid request
+  vector<word_t> _req_bits ;
+
+  static void _Set( word_t * m, int i ) {
+    m[i >> 6] |= 1ULL << ( i & 63 ) ;
+  }
+  static void _Reset( word_t * m, int i ) {
+    m[i >> 6] &= ~( 1ULL << ( i & 63 ) ) ;
+  }
+  void _ClearMask( word_t * m ) const {
+    for ( int w = 0 ; w < _words ; ++w ) {
+      m[w] = 0 ;
+    }
+  }
+  static bool _Test( word_t const * m, int i ) {
+    return ( m[i >> 6] >> ( i & 63 ) ) & 1 ;
+  }
+
+  // First set bit of m at or after start, wrapping around; -1 if m is
+  // empty. For a single word this is a rotate and a count-trailing-zeros.
+  int _FirstFrom( word_t const * m, int start ) const ;
+
+public:
+
+  BitsArbiter( Module *parent, const string &name, int size ) ;
+
+  // same bookkeeping as Arbiter::AddRequest, kept inline since it runs
+  // once per requester
+  virtual void AddRequest( int input, int id, int pri ) {
+    assert( 0 <= input && input < _size ) ;
+    assert( !_request[input].valid );
+
+    _num_reqs++ ;
+    _request[input].valid = true ;
+    _request[input].id = id ;
+    _request[input].pri = pri ;
+    _Set( &_req_bits[0], input ) ;
+  }
+
+  virtual void Clear() ;
+
+} ;
+
+#endif
@@ -0,0 +1,138 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// ----------------------------------------------------------------------
+//
+//  MatrixBits: Matrix Arbiter with the priority matrix stored as bit rows
+//
+// ----------------------------------------------------------------------
+
+#include "matrix_bits_arb.hpp"
+#include <iostream>
+#include <limits>
+#include <cassert>
+using namespace std ;
+
+MatrixBitsArbiter::MatrixBitsArbiter( Module *parent, const string &name, int size )
+  : BitsArbiter( parent, name, size ), _last_req(-1) {
+  // same initial order as MatrixArbiter: higher inputs have priority
+  _beaten_by.resize(size * _words, 0);
+  for ( int i = 0 ; i < size ; i++ ) {
+    for ( int j = i + 1; j < size; j++ ) {
+      _Set( &_beaten_by[i * _words], j );
+    }
+  }
+  _top_bits.resize(_words, 0);
+}
+
+void MatrixBitsArbiter::PrintState() const  {
+  cout << "Priority Matrix: " << endl ;
+  for ( int r = 0; r < _size ; r++ ) {
+    for ( int c = 0 ; c < _size ; c++ ) {
+      cout << ( _Test( &_beaten_by[c * _words], r ) ? 1 : 0 ) << " " ;
+    }
+    cout << endl ;
+  }
+  cout << endl ;
+}
+
+void MatrixBitsArbiter::UpdateState() {
+  // update priority matrix using last grant: the winner drops below
+  // everybody else
+  if ( _selected > -1 ) {
+    for ( int i = 0; i < _size ; i++ ) {
+      _Reset( &_beaten_by[i * _words], _selected ) ;
+    }
+    word_t * const row = &_beaten_by[_selected * _words] ;
+    for ( int w = 0; w < _words ; w++ ) {
+      row[w] = ~0ULL ;
+    }
+    if ( _size & 63 ) {
+      row[_words - 1] = ( 1ULL << ( _size & 63 ) ) - 1 ;
+    }
+    _Reset( row, _selected ) ;
+  }
+}
+
+void MatrixBitsArbiter::AddRequest( int input, int id, int pri )
+{
+  _last_req = input;
+  if ( ( _num_reqs == 0 ) || ( pri > _highest_pri ) ) {
+    _ClearMask( &_top_bits[0] );
+    _highest_pri = pri;
+  }
+  if ( pri == _highest_pri ) {
+    _Set( &_top_bits[0], input );
+  }
+  BitsArbiter::AddRequest( input, id, pri );
+}
+
+int MatrixBitsArbiter::Arbitrate( int* id, int* pri ) {
+
+  // avoid running arbiter if it has not recevied at least two requests
+  // (in this case, requests and grants are identical)
+  if ( _num_reqs < 2 ) {
+
+    _selected = _last_req ;
+
+  } else {
+
+    // only requests at the highest priority can win, and among those the
+    // order is total, so exactly one has nobody ahead of it
+    _selected = -1 ;
+
+    for ( int w = 0 ; ( w < _words ) && ( _selected < 0 ) ; w++ ) {
+      word_t bits = _top_bits[w] ;
+      while ( bits ) {
+	int const input = w * 64 + __builtin_ctzll( bits ) ;
+	word_t const * const row = &_beaten_by[input * _words] ;
+	bool grant = true ;
+	for ( int v = 0 ; v < _words ; v++ ) {
+	  if ( row[v] & _top_bits[v] ) {
+	    grant = false ;
+	    break ;
+	  }
+	}
+	if ( grant ) {
+	  _selected = input ;
+	  break ;
+	}
+	bits &= bits - 1 ;
+      }
+    }
+    assert( _selected >= 0 ) ;
+  }
+
+  return Arbiter::Arbitrate(id, pri);
+}
+
+void MatrixBitsArbiter::Clear()
+{
+  _last_req = -1;
+  _highest_pri = numeric_limits<int>::min();
+  BitsArbiter::Clear();
+}
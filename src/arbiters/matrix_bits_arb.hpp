@@ -0,0 +1,78 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// ----------------------------------------------------------------------
+//
+//  MatrixBits: Matrix Arbiter with the priority matrix stored as bit rows
+//
+//  Row i holds the inputs that currently have priority over input i, so
+//  a request wins when its row does not intersect the set of competing
+//  requests at the same (highest) priority level.
+//
+// ----------------------------------------------------------------------
+
+#ifndef _MATRIX_BITS_ARB_HPP_
+#define _MATRIX_BITS_ARB_HPP_
+
+#include <vector>
+
+#include "bits_arb.hpp"
+
+using namespace std;
+
+class MatrixBitsArbiter : public BitsArbiter {
+
+  // _beaten_by[i * _words ...]: inputs with priority over input i
+  vector<word_t> _beaten_by ;
+
+  // requests at _highest_pri
+  vector<word_t> _top_bits ;
+
+  int  _last_req ;
+
+public:
+
+  // Constructors
+  MatrixBitsArbiter( Module *parent, const string &name, int size ) ;
+
+  // Print priority matrix to standard output
+  virtual void PrintState() const ;
+
+  // Update priority matrix based on last aribtration result
+  virtual void UpdateState() ;
+
+  // Arbitrate amongst requests. Returns winning input and
+  // updates pointers to metadata when valid pointers are passed
+  virtual int Arbitrate( int* id = 0, int* pri = 0) ;
+
+  virtual void AddRequest( int input, int id, int pri ) ;
+
+  virtual void Clear();
+
+} ;
+
+#endif
@@ -0,0 +1,80 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// ----------------------------------------------------------------------
+//
+//  RoundRobinBits: Round Robin Arbiter on request masks
+//
+// ----------------------------------------------------------------------
+
+#include "roundrobin_bits_arb.hpp"
+#include <iostream>
+#include <limits>
+
+using namespace std ;
+
+RoundRobinBitsArbiter::RoundRobinBitsArbiter( Module *parent, const string &name,
+					      int size )
+  : BitsArbiter( parent, name, size ), _pointer( 0 ) {
+  _top_bits.resize(_words, 0);
+}
+
+void RoundRobinBitsArbiter::PrintState() const  {
+  cout << "Round Robin Priority Pointer: " << endl ;
+  cout << "  _pointer = " << _pointer << endl ;
+}
+
+void RoundRobinBitsArbiter::UpdateState() {
+  // update priority matrix using last grant
+  if ( _selected > -1 )
+    _pointer = ( _selected + 1 ) % _size ;
+}
+
+void RoundRobinBitsArbiter::AddRequest( int input, int id, int pri )
+{
+  if ( ( _num_reqs == 0 ) || ( pri > _highest_pri ) ) {
+    _ClearMask( &_top_bits[0] );
+    _highest_pri = pri;
+  }
+  if ( pri == _highest_pri ) {
+    _Set( &_top_bits[0], input );
+  }
+  BitsArbiter::AddRequest( input, id, pri );
+}
+
+int RoundRobinBitsArbiter::Arbitrate( int* id, int* pri ) {
+
+  _selected = ( _num_reqs > 0 ) ? _FirstFrom( &_top_bits[0], _pointer ) : -1 ;
+
+  return Arbiter::Arbitrate(id, pri);
+}
+
+void RoundRobinBitsArbiter::Clear()
+{
+  _highest_pri = numeric_limits<int>::min();
+  BitsArbiter::Clear();
+}
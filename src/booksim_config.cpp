@@ -134,6 +134,9 @@ BookSimConfig::BookSimConfig( )
   _int_map["c"] = 1; //concentration
   _int_map["m"] = 0; // Bransan number of wireless routers
   AddStrField( "routing_function", "dor" );
+  // max router x destination entries of a dense routing table, beyond
+  // which mesh/torus routing uses per-dimension tables (0 disables both)
+  _int_map["route_table_size"] = 1 << 22;
 
   //simulator tries to correclty adjust latency for node/router placement 
   _int_map["use_noc_latency"] = 1;
@@ -165,6 +168,8 @@ BookSimConfig::BookSimConfig( )
   //==== General options ===================================
 
   AddStrField( "router", "iq" ); 
+  // use the fixed port/VC count IQRouter for 2D mesh DOR networks
+  _int_map["router_specialize"] = 1;
 
   _int_map["output_delay"] = 0;
   _int_map["credit_delay"] = 0;
@@ -375,6 +380,14 @@ BookSimConfig::BookSimConfig( )
 
   _int_map["deadlock_warn_timeout"] = 10000;
 
+  _int_map["fast_forward"] = 0; // jump over cycles in which the network is empty and all cores are computing
+  _int_map["pool_trim"] = 0; // free idle flit/credit slabs whenever the network drains
+  _int_map["sim_threads"] = 1; // threads stepping routers and channels; results match the serial run
+  // workload IR, JSON or the binary form written by booksim-ir-convert;
+  // "" reads the JSON schedule under the result route
+  AddStrField("ir_file", "");
+  _int_map["paint_json"] = 1; // rebuild _paint.json from the streamed _paint.jsonl after the run
+
   _int_map["viewer_trace"] = 0;
   _int_map["watch_deadlock"] = 0;
   _int_map["watch_all_cores"] = 1;
@@ -420,6 +433,10 @@ BookSimConfig::BookSimConfig( )
 
   //==================Network file===========================
   AddStrField("network_file","");
+  // binary copy of the parsed network file and its routing table, reused
+  // while the file is unchanged; "" keeps it next to network_file, "-" disables it
+  AddStrField("network_cache","");
+  _int_map["route_threads"] = 0; // threads building the anynet routing table, 0 for one per core
 
 
   
@@ -74,9 +74,9 @@ Buffer::~Buffer()
   }
 }
 
-void Buffer::addFlitMCastEntry( int vc, int dest, int out_port, bool wflag )
+void Buffer::addFlitMCastEntry( int vc, const NodeSet & dests, int out_port, bool wflag )
 {
-  _vc[vc]->addFlitMCastEntry(dest, out_port, wflag );
+  _vc[vc]->addFlitMCastEntry(dests, out_port, wflag );
 }
 
 void Buffer::AddFlit( int vc, Flit *f )
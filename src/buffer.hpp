@@ -55,7 +55,7 @@ public:
 	  Module *parent, const string& name, int is_hub =0);
   ~Buffer();
 
-  void addFlitMCastEntry( int vc, int dest, int out_port, bool wflag );
+  void addFlitMCastEntry( int vc, const NodeSet & dests, int out_port, bool wflag );
   void AddFlit( int vc, Flit *f );
 
   inline Flit *RemoveFlit( int vc )
@@ -99,7 +99,7 @@ public:
     return _vc[vc]->GetRouteSet( );
   }
   
-  inline const vector<int> GetMulticastOutpair( int vc ) const
+  inline const vector<int> & GetMulticastOutpair( int vc ) const
   {
     return _vc[vc]->GetMulticastOutpair( );
   }
@@ -151,7 +151,7 @@ public:
     return _vc[vc]->GetInterDest( );
   }
 
-  inline map<int, pair<vector<int>, vector<int> > > GetMcastTable( int vc )
+  inline const McastTable & GetMcastTable( int vc ) const
   {
     return _vc[vc]->GetMcastTable( );
   }
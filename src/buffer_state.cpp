@@ -557,6 +557,11 @@ BufferState::BufferState( const Configuration& config, Module *parent, const str
   Module( parent, name ), _occupancy(0)
 {
   _vcs = config.GetInt( "num_vcs" );
+  if ( _vcs > Credit::MAX_VCS ) {
+    ostringstream err;
+    err << "Credits support at most " << Credit::MAX_VCS << " VCs";
+    Error( err.str() );
+  }
   _size = config.GetInt("buf_size");
   // if(_size < 0) {
   //   _size = _vcs * config.GetInt("vc_buf_size");
@@ -609,10 +614,8 @@ void BufferState::ProcessCredit( Credit const * const c )
 {
   assert( c );
 
-  set<int>::iterator iter = c->vc.begin();
-  // cout<<"Size of VC "<<c->vc.size()<<endl;
-  while(iter != c->vc.end()) {
-    int const vc = *iter;
+  // cout<<"Size of VC "<<c->NumVCs()<<endl;
+  for(int vc = c->FirstVC(); vc >= 0; vc = c->NextVC(vc)) {
     // cout<<"VC value "<<vc<<endl;
     assert( ( vc >= 0 ) && ( vc < _vcs ) );
 
@@ -649,8 +652,6 @@ void BufferState::ProcessCredit( Credit const * const c )
 #endif
 
     _buffer_policy->FreeSlotFor(vc);
-
-    ++iter;
   }
 }
 
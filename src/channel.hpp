@@ -33,6 +33,10 @@
 //   transmission delay. The channel latency can be specified as 
 //   an integer number of simulator cycles.
 //
+//  Channels are not stepped by the network; Send registers the data
+//   with the network's TimingWheel, which calls Deliver in the cycle
+//   it comes due and Retire one cycle later.
+//
 /////
 #ifndef _CHANNEL_HPP
 #define _CHANNEL_HPP
@@ -43,11 +47,12 @@
 #include "globals.hpp"
 #include "module.hpp"
 #include "timed_module.hpp"
+#include "timing_wheel.hpp"
 
 using namespace std;
 
 template<typename T>
-class Channel : public TimedModule {
+class Channel : public TimedModule, public TimingWheel::Client {
 public:
   Channel(Module * parent, string const & name);
   virtual ~Channel() {}
@@ -55,6 +60,10 @@ public:
   // Physical Parameters
   void SetLatency(int cycles);
   int GetLatency() const { return _delay ; }
+
+  // module that reads this channel's output; woken on delivery
+  void SetReceiver(TimedModule * receiver) { _receiver = receiver; }
+  void SetTimingWheel(TimingWheel * wheel) { _wheel = wheel; }
   
   // Send data 
   virtual void Send(T * data);
@@ -62,21 +71,31 @@ public:
   // Receive data
   virtual T * Receive(); 
   
-  virtual void ReadInputs();
+  virtual void ReadInputs() {}
   virtual void Evaluate() {}
-  virtual void WriteOutputs();
+  virtual void WriteOutputs() {}
+
+  virtual bool IsActive() const {
+    return _output || !_wait_queue.empty();
+  }
+  virtual bool IsThreadSafe() const { return true; }
+
+  virtual void Deliver();
+  virtual void Retire();
 
 protected:
   int _delay;
-  T * _input;
   T * _output;
-  queue<pair<int, T *> > _wait_queue;
+  TimedModule * _receiver;
+  TimingWheel * _wheel;
+  // the delay is fixed, so items come due in the order they were sent
+  queue<T *> _wait_queue;
 
 };
 
 template<typename T>
 Channel<T>::Channel(Module * parent, string const & name)
-  : TimedModule(parent, name), _delay(1), _input(0), _output(0) {
+  : TimedModule(parent, name), _delay(1), _output(0), _receiver(0), _wheel(0) {
 }
 
 template<typename T>
@@ -89,7 +108,11 @@ void Channel<T>::SetLatency(int cycles) {
 
 template<typename T>
 void Channel<T>::Send(T * data) {
-  _input = data;
+  if(data) {
+    assert(_wheel);
+    _wait_queue.push(data);
+    _wheel->Schedule(this, GetSimTime() + _delay);
+  }
 }
 
 template<typename T>
@@ -98,28 +121,18 @@ T * Channel<T>::Receive() {
 }
 
 template<typename T>
-void Channel<T>::ReadInputs() {
-  if(_input) {
-    _wait_queue.push(make_pair(GetSimTime() + _delay - 1, _input));
-    _input = 0;
+void Channel<T>::Deliver() {
+  assert(!_wait_queue.empty());
+  _output = _wait_queue.front();
+  _wait_queue.pop();
+  if(_receiver) {
+    _receiver->Wake();
   }
 }
 
 template<typename T>
-void Channel<T>::WriteOutputs() {
+void Channel<T>::Retire() {
   _output = 0;
-  if(_wait_queue.empty()) {
-    return;
-  }
-  pair<int, T *> const & item = _wait_queue.front();
-  int const & time = item.first;
-  if(GetSimTime() < time) {
-    return;
-  }
-  assert(GetSimTime() == time);
-  _output = item.second;
-  assert(_output);
-  _wait_queue.pop();
 }
 
 #endif
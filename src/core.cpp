@@ -58,11 +58,15 @@ todo:
 /*
 1.choose to guarantee that all requests are received, the data can be sent; in the future, the sub tile should be fully received.
 */
+#include <limits>
+#include <algorithm>
+
 #include "booksim.hpp"
 #include "core.hpp"
 
 
-Core::Core(const Configuration& config, int id, vector<int> ddr_id, const nlohmann::json& j)
+Core::Core(const Configuration& config, int id, vector<int> ddr_id, const WorkloadIR& ir, PaintWriter& paint)
+   : _ir(ir), _paint(paint)
 {  
    _num_obuf = config.GetInt("num_obuf");
    _num_flits= config.GetInt("packet_size")-1;//data flits
@@ -79,22 +83,20 @@ Core::Core(const Configuration& config, int id, vector<int> ddr_id, const nlohma
     vector<int> temp = config.GetIntArray("watch_cores");
 	_overall_end = false;
 	if (config.GetInt("watch_all_cores")) {
-		for (int i = 0; i < config.GetInt("k") * config.GetInt("k"); i++) {
-			_watch_cores.insert(i);
-		}
+		_watched = gWatchBuild && id < config.GetInt("k") * config.GetInt("k");
 	}
 	else {
-		for (auto x : temp) {
-			_watch_cores.insert(x);
-		}
+		_watched = gWatchBuild && find(temp.begin(), temp.end(), id) != temp.end();
 	}
 	vector<int> temp1 = config.GetIntArray("watch_transfer_id");
 	for (auto x : temp1) {
-		_watch_ids.insert(x);
+		_watch_ids.Insert(x);
 	}
-   _core_id = to_string(id);
-   _j[_core_id] = j[_core_id];
-   _wl_num = _j[_core_id].size();
+   _core_id = id;
+   _workloads = _ir.Workloads(id);
+   _wl = NULL;
+   _wl_num = _ir.NumWorkloads(id);
+   _layer = 0;
    _end_message.resize(2);
    _cur_wl_id = -1;
    _cur_id = -1;
@@ -128,11 +130,12 @@ void Core::_update()
 		_wl_end = true;
 	}
 	else {
-		_cur_wl_id = _j[_core_id][_cur_id]["workload_id"].get<int>();
-		_cp_time = _j[_core_id][_cur_id]["time"].get<int>();
-		_of_size = _j[_core_id][_cur_id]["ofmap_size"].get<int>();
+		_wl = _workloads + _cur_id;
+		_cur_wl_id = _wl->workload_id;
+		_cp_time = _wl->time;
+		_of_size = _wl->ofmap_size;
 		_cur_tile_id = 0;
-		_layer_name = _j[_core_id][_cur_id]["layer_name"].get<string>();
+		_layer = _wl->layer;
 		//try best to use up a packet
 		if (_of_size / _sd_gran < (_flit_width * _num_flits)) {
 			_sd_gran = (_of_size - 1) / (_flit_width * _num_flits) + 1 > _sd_gran_lb ?
@@ -141,40 +144,35 @@ void Core::_update()
 
 		_tile_time.assign(_sd_gran - 1, (_cp_time - 1) / _sd_gran);
 		_tile_time.push_back(_cp_time - (_sd_gran - 1) * ((_cp_time - 1) / _sd_gran));
-		int i = 0;
 		
-		for (auto& x : _j[_core_id][_cur_id]["ofmap"]) {
+		for (int o = _wl->ofmap_begin; o < _wl->ofmap_end; o++) {
+			const WorkloadIR::Ofmap& x = _ir.GetOfmap(o);
 			pair<vector<int>, unordered_set<int>>temp;
 			pair<vector<int>, unordered_set<int>>temp1;
 			list<pair<vector<int>, unordered_set<int>>>temp2;
 			temp.first.resize(2);
 			temp1.first.resize(2);
-			for (auto& y : x["destination"]) {
-				if (y["type"].get<string>().compare("DRAM") == 0) {
+			for (int d = x.dest_begin; d < x.dest_end; d++) {
+				const WorkloadIR::Dest& y = _ir.GetDest(d);
+				if (y.dram) {
 					temp.second.insert(-1);
 					temp1.second.insert(-1);
 				}
-				else if (y["id"] != stoi(_core_id)) {
-					temp.second.insert(y["id"].get<int>());
-					temp1.second.insert(y["id"].get<int>());//
-					if (_cur_wl_rq[x["transfer_id"].get<int>()].count(y["id"].get<int>()) == 0)
-						_cur_wl_rq[x["transfer_id"].get<int>()][y["id"].get<int>()] = 1;
+				else if (y.id != _core_id) {
+					temp.second.insert(y.id);
+					temp1.second.insert(y.id);//
+					if (_cur_wl_rq[x.transfer_id].count(y.id) == 0)
+						_cur_wl_rq[x.transfer_id][y.id] = 1;
 					else
-						_cur_wl_rq[x["transfer_id"].get<int>()][y["id"].get<int>()]++;
+						_cur_wl_rq[x.transfer_id][y.id]++;
 				}
 			}
 			if (!temp.second.empty()) {
-				_send_data_list[x["transfer_id"]] = x["size"].get<int>();
-				if (_send_data_list.count(79) > 0) {
-					int p = 1;
-				}
-				temp.first[0] = x["transfer_id"];
-				temp1.first[0] = x["transfer_id"];
-				if (x["transfer_id"] == 20) {
-					int p = 1;
-				}
-				temp.first[1] = x["size"].get<int>() / _sd_gran;
-				temp1.first[1] = x["size"].get<int>() - temp.first[1] * (_sd_gran - 1);
+				_send_data_list[x.transfer_id] = x.size;
+				temp.first[0] = x.transfer_id;
+				temp1.first[0] = x.transfer_id;
+				temp.first[1] = x.size / _sd_gran;
+				temp1.first[1] = x.size - temp.first[1] * (_sd_gran - 1);
 
 				temp2.assign(_sd_gran - 1, temp);
 				temp2.push_back(temp1);
@@ -239,16 +237,13 @@ void Core::_update()
 		}
 	}
 
-void Core::run(int time, bool empty, list<Flit*>& _flits_sending) {
+void Core::run(int time, bool empty, vector<Flit*>& _flits_sending) {
 //	receive_message(f);
 	_time = time;
-	if (_core_id == "1" && pending) {
-//		cout << "here"<<endl;
-	}
 
 
 	if (_wl_fn && _next_start && _dataready && _cur_rc_obuf!=-1&&!_wl_end) {
-		//if (stoi(_core_id)==13){//_watch_cores.count(stoi(_core_id)) > 0) {
+		//if (stoi(_core_id)==13){//_watched) {
 		//	cout << "excute 13 here";
 		//}
 		_next_start = false;
@@ -256,9 +251,6 @@ void Core::run(int time, bool empty, list<Flit*>& _flits_sending) {
 		_wl_fn = false;
 		_dataready = false;
 		_start_wl_time = _time;
-		_j_example[_core_id][to_string(_cur_id)]["start"] = _time;
-		_j_example[_core_id][to_string(_cur_id)]["layer"] = _layer_name;
-		_j_example[_core_id][to_string(_cur_id)]["batch"] = _j[_core_id][_cur_id]["workload"][1][0].get<int>()- _j[_core_id][_cur_id]["workload"][0][0].get<int>() +1;
 		_start_tile_time = _time;
 		_end_tile_time = _start_tile_time + _tile_time.front(); //neglect non-integer part
 	}
@@ -271,7 +263,7 @@ void Core::run(int time, bool empty, list<Flit*>& _flits_sending) {
 	if (_running && !_wl_end ) {
 		
 		if (_time == _end_tile_time) {
-			if (_watch_cores.count(stoi(_core_id)) > 0) {
+			if (_watched) {
 				int here = 1;
 			}
 			
@@ -286,9 +278,9 @@ void Core::run(int time, bool empty, list<Flit*>& _flits_sending) {
 			if (_tile_time.empty()) {
 				assert(_tile_size.empty());
 				_wl_fn = true;
-				_j_example[_core_id][to_string(_cur_id)]["end"] = _time;
+				_paint.Workload(_core_id, _cur_id, _start_wl_time, _time, &_ir.LayerName(_layer), _wl->batch);
 				cnt1 = 0;
-				if (_watch_cores.count(stoi(_core_id))>0 ){
+				if (_watched) {
 					cout << "this core is = " << _core_id << " cur_id " << _cur_id << " cur_workload_id = "<<_cur_wl_id<< " is finished at " <<_time << " left_workload = "<<_wl_num-1-_cur_id<<"\n";
 				}
 			} else if (_cur_rc_obuf == -1 ) {
@@ -308,7 +300,7 @@ void Core::run(int time, bool empty, list<Flit*>& _flits_sending) {
 	}
 
 	if (_wl_fn && _cur_wl_rq.empty() && !_wl_end && cnt1==0) {
-		if (_watch_cores.count(stoi(_core_id)) > 0) {
+		if (_watched) {
 			int here = 1;
 		}
 		_next_start = true;
@@ -324,7 +316,6 @@ void Core::run(int time, bool empty, list<Flit*>& _flits_sending) {
 					f->mflag = true;
 					f->flits_num = 1;
 					f->to_ddr = true;
-					f->mdest.first.reserve(_ddr_num);
 				}
 				else {
 					f->dest = _s_rq_list[p.first].second[0];
@@ -338,7 +329,7 @@ void Core::run(int time, bool empty, list<Flit*>& _flits_sending) {
 				if (_time == 647059) {
 					cout << "here";
 				}
-				if (_watch_cores.count(stoi(_core_id)) > 0 || _watch_ids.count(f->transfer_id)>0) {
+				if (_watched || _watch_ids.Contains(f->transfer_id)) {
 					cout << "this core is = " << _core_id << " send requirment transfer_id " << p.first << " mflag " << f->mflag << " inject time = " << f->ctime << "\n";
 				}
 			}
@@ -350,13 +341,13 @@ void Core::run(int time, bool empty, list<Flit*>& _flits_sending) {
 	bool finish = false;
 	//cout << empty << "\n";
 	if (!_requirements_to_send.empty() && empty &&!_wl_end) {
-		if (stoi(_core_id) == 12) {//_watch_cores.count(stoi(_core_id)) > 0) {
+		if (_watched) {
 			int here = 1;
 		}
 		do {
 			if (_requirements_to_send.front()->head && _requirements_to_send.front()->to_ddr) {
 				for (int i = 0; i < _ddr_num; i++) {
-					_requirements_to_send.front()->mdest.first.push_back(_ddr_id[i * _ddr_rnum + rand() % _ddr_rnum]);
+					_requirements_to_send.front()->MutableMdest().first.Insert(_ddr_id[i * _ddr_rnum + rand() % _ddr_rnum]);
 				}
 			}
 			_flits_sending.push_back(_requirements_to_send.front());
@@ -367,7 +358,7 @@ void Core::run(int time, bool empty, list<Flit*>& _flits_sending) {
 	}
 	
 	else if (_requirements_to_send.empty()  && empty && _cur_sd_obuf!=-1&&!_overall_end) {
-		if (_watch_cores.count(stoi(_core_id)) > 0) {
+		if (_watched) {
 			int here = 1;
 		}
 		assert(!o_buf[_cur_sd_obuf].first.empty());
@@ -390,7 +381,7 @@ void Core::run(int time, bool empty, list<Flit*>& _flits_sending) {
 void Core::receive_message(Flit*f) {
 	assert(f->tail);//For request, head is tail ; For data, after tail comes, update buffer.
 	if (f->nn_type == 5 ) {
-		if (_watch_cores.count(stoi(_core_id)) > 0 || _watch_ids.count(f->transfer_id)>0) {
+		if (_watched || _watch_ids.Contains(f->transfer_id)) {
 			cout << "this core is = " << _core_id << " receive requirement transfer_id " << f->transfer_id << " cur_workload_id = " << _cur_wl_id << " src= " << f->src << " inject time = " << f->ctime << "\n";
 		}
 		if (_cur_wl_rq.count(f->transfer_id) == 0) {
@@ -409,10 +400,10 @@ void Core::receive_message(Flit*f) {
 		}
 	}
 	if (f->nn_type == 6) {
-//		if (_watch_cores.count(stoi(_core_id)) > 0 ) {
+//		if (_watched) {
 //			cout << "this core is = " << _core_id << " receive transfer_id " << f->transfer_id << " src= " << f->src << "size = " << f->size << " create time = " << f->ctime << "\n";
 //		}
-//		if (_watch_ids.count(f->transfer_id) > 0 && !f->end) {
+//		if (_watch_ids.Contains(f->transfer_id) && !f->end) {
 //			cout << "this core is = " << _core_id << " receive transfer_id " << f->transfer_id << " src= " << f->src << "size = " << f->size << " create time = " << f->ctime << "\n";
 //		}
 		_s_rq_list[f->transfer_id].second[1] = _s_rq_list[f->transfer_id].second[1] - f->size;
@@ -420,7 +411,7 @@ void Core::receive_message(Flit*f) {
 		
 		if (f->end) {
 
-			if (_watch_cores.count(stoi(_core_id)) > 0 || _watch_ids.count(f->transfer_id) > 0) {
+			if (_watched || _watch_ids.Contains(f->transfer_id)) {
 				cout << "this core is = " << _core_id << " receive end transfer_id " << f->transfer_id << " cur_workload_id = " << _cur_wl_id <<  " src= " << f->src << " inject time = " << f->ctime << "\n";
 				if (f->transfer_id==37) {
 					int here = 1;
@@ -454,7 +445,7 @@ void Core::receive_message(Flit*f) {
 //			cout<< " remaining_size = "<<_s_rq_list[f->transfer_id][1]<<"\n";
 //			cout << " remaining_end_to_recieve = " << _s_rq_list[f->transfer_id][2] << "\n";
 			assert(_s_rq_list[f->transfer_id][1] == 0,"received data no match");
-			_core_buffer[f->layer_name].insert(f->transfer_id);
+			_core_buffer[Flit::LayerName(f->layer)].insert(f->transfer_id);
 		}
 		_left_data.erase(f->transfer_id);
 	}*/
@@ -463,51 +454,46 @@ void Core::receive_message(Flit*f) {
 }
 //todo delete out-of-date data
 void Core::_buffer_update()
-{/**/
-	if (_core_id == to_string(1)) {
-		int p = 1;
-	}
-	for (auto& x : _j[_core_id][_cur_id]["buffer"]) {
-		if (x["type"].get<string>().compare("ofmap")!=0) {
-			if (x["newly_added"].get<bool>() == true) {
-				for (auto& y : x["source"]) {
-
-					if (_watch_cores.count(stoi(_core_id)) > 0) {
-						cout << y["transfer_id"] << "\n";
-						cout << x["layer"] << "\n";
-				}
-					if (y["id"] == stoi(_core_id)) {
+{
+	for (int b = _wl->buffer_begin; b < _wl->buffer_end; b++) {
+		const WorkloadIR::Buffer& x = _ir.GetBuffer(b);
+		for (int i = x.source_begin; i < x.source_end; i++) {
+			const WorkloadIR::Source& y = _ir.GetSource(i);
+
+			if (_watched) {
+				cout << y.transfer_id << "\n";
+				cout << '"' << _ir.LayerName(x.layer) << '"' << "\n";
+			}
+			if (y.id == _core_id) {
 
-						_core_buffer[x["layer"]].insert(y["transfer_id"].get<int>());
-					}
+				_core_buffer[x.layer].insert(y.transfer_id);
+			}
 					
-					if (_core_buffer.count(x["layer"]) > 0) {
-						if (_core_buffer[x["layer"]].count(y["transfer_id"]) > 0) {
-							continue;
-						}
-					}
-					if (_s_rq_list.count(y["transfer_id"]) == 0) {
-						_s_rq_list[y["transfer_id"]].second.resize(3);
-
-						if (y["type"].get<string>().compare("DRAM") != 0) {
-							_s_rq_list[y["transfer_id"]].second[0] = y["id"].get<int>();
-							_s_rq_list[y["transfer_id"]].second[1] = y["size"].get<int>();
-							_s_rq_list[y["transfer_id"]].second[2] = 1;
-						}
-						else if (y["id"] != stoi(_core_id)) {
-							_s_rq_list[y["transfer_id"]].second[0] = -1;
-							_s_rq_list[y["transfer_id"]].second[1] = y["size"].get<int>();
-							_s_rq_list[y["transfer_id"]].second[2] = _interleave ? _ddr_num : 1;//to revise it into ddr group number
-						}
-					}
-					_s_rq_list[y["transfer_id"]].first.insert(x["layer"]);
-					if (_rq_to_sent.count(y["transfer_id"].get<int>()) == 0) {
-						_rq_to_sent[y["transfer_id"].get<int>()]=1;
-					}
-					else {
-						_rq_to_sent[y["transfer_id"].get<int>()]++;
-					}
+			unordered_map<int, unordered_set<int>>::const_iterator buf = _core_buffer.find(x.layer);
+			if (buf != _core_buffer.end() && buf->second.count(y.transfer_id) > 0) {
+				continue;
+			}
+			if (_s_rq_list.count(y.transfer_id) == 0) {
+				vector<int>& rq = _s_rq_list[y.transfer_id].second;
+				rq.resize(3);
+
+				if (!y.dram) {
+					rq[0] = y.id;
+					rq[1] = y.size;
+					rq[2] = 1;
 				}
+				else if (y.id != _core_id) {
+					rq[0] = -1;
+					rq[1] = y.size;
+					rq[2] = _interleave ? _ddr_num : 1;//to revise it into ddr group number
+				}
+			}
+			_s_rq_list[y.transfer_id].first.insert(x.layer);
+			if (_rq_to_sent.count(y.transfer_id) == 0) {
+				_rq_to_sent[y.transfer_id]=1;
+			}
+			else {
+				_rq_to_sent[y.transfer_id]++;
 			}
 		}
 	}
@@ -517,41 +503,16 @@ bool Core::_data_ready()
 {
 	_left_data.clear();
 	bool temp = true;
-	if (_core_buffer.count(_j[_core_id][_cur_id]["layer_name"].get<string>()) != 0) {
-		for (auto& x : _j[_core_id][_cur_id]["ifmap"]["transfer_id"]) {
-			if (_core_buffer[_j[_core_id][_cur_id]["layer_name"].get<string>()].count(x.get<int>()) != 0)
-				continue;
-			else {
-				_left_data.insert(x.get<int>());
-				temp = false;
-			}
-		}
-		if (_j[_core_id][_cur_id].count("weight") != 0) {
-			for (auto& x : _j[_core_id][_cur_id]["weight"]["transfer_id"]) {
-				if (_core_buffer[_j[_core_id][_cur_id]["layer_name"].get<string>()].count(x.get<int>()) != 0)
-					continue;
-				else {
-					_left_data.insert(x.get<int>());
-					temp = false;
-				}
-			}
-		}
-	}
-	else {
-		for (auto& x : _j[_core_id][_cur_id]["ifmap"]["transfer_id"]) {
-				_left_data.insert(x.get<int>());
-				temp = false;
-		}
-		if (_j[_core_id][_cur_id].count("weight") != 0) {
-			for (auto& x : _j[_core_id][_cur_id]["weight"]["transfer_id"]) {
-					_left_data.insert(x.get<int>());
-					temp = false;
-			}
-		}
+	unordered_map<int, unordered_set<int>>::const_iterator buf = _core_buffer.find(_layer);
+	//ifmap transfers followed by weight transfers
+	for (int t = _wl->ifmap_begin; t < _wl->weight_end; t++) {
+		int transfer_id = _ir.GetTransfer(t);
+		if (buf != _core_buffer.end() && buf->second.count(transfer_id) != 0)
+			continue;
+		_left_data.insert(transfer_id);
+		temp = false;
 	}
 	return temp;
-	
-		
 }
 /*
 bool Core::_test_obuf() {
@@ -609,7 +570,7 @@ vector<int>& Core::_check_end() {
 void Core::_write_obuf() {
 	o_buf[_cur_rc_obuf].first.reserve(_tile_size.size());
 	obuf_wl_id[_cur_rc_obuf].first = _cur_id;
-	obuf_wl_id[_cur_rc_obuf].second = _layer_name;
+	obuf_wl_id[_cur_rc_obuf].second = _ir.FlitLayer(_layer);
 	int i;
 	int size = _tile_size.size();
 	o_buf[_cur_rc_obuf].second = size;
@@ -625,7 +586,7 @@ void Core::_write_obuf() {
 }
 
 
-void Core::_send_data(list<Flit*>& _flits_sending) {
+void Core::_send_data(vector<Flit*>& _flits_sending) {
 	//if (o_buf[_cur_sd_obuf].empty()) {
 	//	if (!_generate_next_sd_obuf_id()) {
 	//		return;
@@ -647,7 +608,7 @@ void Core::_send_data(list<Flit*>& _flits_sending) {
 		int ddr_initial = o_buf[_cur_sd_obuf].first[_sd_mini_tile_id].second.size() * _ddr_num;
 		bool end = false;
 		bool mflas_temp = false;
-		string name = obuf_wl_id[_cur_sd_obuf].second;
+		int layer = obuf_wl_id[_cur_sd_obuf].second;
 		o_buf[_cur_sd_obuf].first[_sd_mini_tile_id].first[1] = o_buf[_cur_sd_obuf].first[_sd_mini_tile_id].first[1] - size;
 		if (transfer_id == 127) {
 			int p = 1;
@@ -707,43 +668,41 @@ void Core::_send_data(list<Flit*>& _flits_sending) {
 			f->mflag = mflas_temp;
 			f->transfer_id = transfer_id;
 			
-			f->layer_name = name;
+			f->layer = layer;
 			if (f->head) {
 				int size_temp = destinations.size();
 				if (size_temp > 1) {
 					f->mflag = true;
 					mflas_temp = true;
 					for (auto& x : destinations) {
-						f->mdest.first.reserve(ddr_initial+size_temp);
 						if (x != -1)
-							f->mdest.first.push_back(x);
+							f->MutableMdest().first.Insert(x);
 						else {
 							if (!end) {
 								if (id_ddr_rel.count(transfer_id) == 0) {
 									id_ddr_rel[transfer_id] = rand() % _ddr_num;
-									f->mdest.first.push_back(_ddr_id[id_ddr_rel[transfer_id] * _ddr_rnum + rand() % _ddr_rnum]);
+									f->MutableMdest().first.Insert(_ddr_id[id_ddr_rel[transfer_id] * _ddr_rnum + rand() % _ddr_rnum]);
 								}
 								else {
 									if (id_ddr_rel[transfer_id] < _ddr_num - 1) {
 										id_ddr_rel[transfer_id] = id_ddr_rel[transfer_id] + 1;
-										f->mdest.first.push_back(_ddr_id[id_ddr_rel[transfer_id] * _ddr_rnum + rand() % _ddr_rnum]);
+										f->MutableMdest().first.Insert(_ddr_id[id_ddr_rel[transfer_id] * _ddr_rnum + rand() % _ddr_rnum]);
 									}
 									else if (id_ddr_rel[transfer_id] == _ddr_num - 1) {
 										id_ddr_rel[transfer_id] = 0;
-										f->mdest.first.push_back(_ddr_id[id_ddr_rel[transfer_id] * _ddr_rnum + rand() % _ddr_rnum]);
+										f->MutableMdest().first.Insert(_ddr_id[id_ddr_rel[transfer_id] * _ddr_rnum + rand() % _ddr_rnum]);
 									}
 								}
 							}
 							else {
 								for (int p = 0; p < _ddr_num; p++) {
-									f->mdest.first.push_back(_ddr_id[p * _ddr_rnum + rand() % _ddr_rnum]);
+									f->MutableMdest().first.Insert(_ddr_id[p * _ddr_rnum + rand() % _ddr_rnum]);
 								}
 							}
 						}
 					}
 				}
 				else if (size_temp == 1) {
-					f->mdest.first.reserve(ddr_initial);
 					for (auto& x : destinations) {
 						if (x != -1) {
 							f->dest = x;
@@ -771,7 +730,7 @@ void Core::_send_data(list<Flit*>& _flits_sending) {
 								f->mflag = true;
 								mflas_temp = true;
 								for (int p = 0; p < _ddr_num; p++) {
-									f->mdest.first.push_back(_ddr_id[p * _ddr_rnum + rand() % _ddr_rnum]);
+									f->MutableMdest().first.Insert(_ddr_id[p * _ddr_rnum + rand() % _ddr_rnum]);
 								}
 							}
 						}
@@ -781,7 +740,7 @@ void Core::_send_data(list<Flit*>& _flits_sending) {
 			
 			if (f->tail) {
 				f->end = end;
-				//if (_watch_ids.count(transfer_id) > 0 && !end) {
+				//if (_watch_ids.Contains(transfer_id) && !end) {
 				//	cout << "this core is = " << _core_id << " send transfer_id " << transfer_id << " mflag " << mflas_temp << " inject time = " << _time << "\n";
 				//}
 			}
@@ -792,17 +751,59 @@ void Core::_send_data(list<Flit*>& _flits_sending) {
 		if (end) {
 			id_ddr_rel.erase(transfer_id);
 			/**/
-			if (_watch_cores.count(stoi(_core_id)) > 0 || _watch_ids.count(transfer_id) > 0) {
+			if (_watched || _watch_ids.Contains(transfer_id)) {
 				cout << "this core is = " << _core_id << " send end transfer_id " << transfer_id << " mflag " << mflas_temp << " cur_workload_id = " << _cur_wl_id <<" inject time = " << _time << "\n";
 			}
 			
 		}
 		
 }
-nlohmann::json& Core::get_json() {
-	return _j_example;
+//mirrors the conditions checked in run(); any cycle that would change state counts as an event
+int Core::next_event(int time, bool empty) const {
+	if (_wl_fn && _next_start && _dataready && _cur_rc_obuf != -1 && !_wl_end) {
+		return time;
+	}
+	int rc_obuf = _cur_rc_obuf;
+	if (pending || rc_obuf == -1) {
+		rc_obuf = -1;
+		for (int i = 0; i < _num_obuf; i++) {
+			if (o_buf[i].first.empty()) {
+				rc_obuf = i;
+				break;
+			}
+		}
+		if (rc_obuf != _cur_rc_obuf) {
+			return time;
+		}
+	}
+	if (_cur_sd_obuf == -1) {
+		for (int i = 0; i < _num_obuf; i++) {
+			if (i != rc_obuf && !o_buf[i].first.empty() && (obuf_wl_id[i].first < _cur_id || _cur_wl_rq.empty())) {
+				return time;
+			}
+		}
+	}
+	if (_running && !_wl_end) {
+		if (time == _end_tile_time || (pending && rc_obuf != -1)) {
+			return time;
+		}
+	}
+	if (_wl_fn && _cur_wl_rq.empty() && !_wl_end && cnt1 == 0) {
+		return time;
+	}
+	if (!_requirements_to_send.empty() && empty && !_wl_end) {
+		return time;
+	}
+	if (_requirements_to_send.empty() && empty && _cur_sd_obuf != -1 && !_overall_end) {
+		return time;
+	}
+	if (_running && !_wl_end && _end_tile_time > time) {
+		return _end_tile_time;
+	}
+	return numeric_limits<int>::max();
 }
 
+
 	
 //}
 
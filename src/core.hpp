@@ -42,19 +42,21 @@
 #include "booksim.hpp"
 #include "config_utils.hpp"
 #include "flit.hpp"
-#include "json.hpp"
+#include "paint_writer.hpp"
+#include "watch_list.hpp"
+#include "workload_ir.hpp"
 using namespace std;
 
 class Core {
 
 public:
-void run(int time,bool empty,list<Flit*>&_flits_sending);
-void _send_data(list<Flit*>& _flits_sending);
+void run(int time,bool empty,vector<Flit*>& _flits_sending);
+void _send_data(vector<Flit*>& _flits_sending);
 vector<int> &_check_end();
+int next_event(int time, bool empty) const;//earliest cycle >= time at which run() acts; empty: the injection queue is empty
 //Flit* send_requirement();
 void receive_message(Flit*f);
-nlohmann::json& get_json();
-Core(const Configuration& config, int id,vector<int>ddr_id, const nlohmann::json& j);
+Core(const Configuration& config, int id,vector<int>ddr_id, const WorkloadIR& ir, PaintWriter& paint);
 ~Core() {};
 private:
 
@@ -65,9 +67,11 @@ private:
   bool _generate_next_rc_obuf_id();
   bool _generate_next_sd_obuf_id();
   void _write_obuf();
-  nlohmann::json _j;
-  nlohmann::json _j_example;
-  string _core_id;
+  const WorkloadIR& _ir;
+  const WorkloadIR::Workload* _workloads;//this core's schedule
+  const WorkloadIR::Workload* _wl;//current workload
+  PaintWriter& _paint;//timeline of finished workloads
+  int _core_id;
   int _cur_wl_id; // id of current wl
   int _wl_num;//total workloads
   int _cur_id; //order of current wl
@@ -83,7 +87,7 @@ private:
   int _end_tile_time; //ending time of the current tile
   int _cur_tile_id;
   int _time;
-  string _layer_name;
+  int _layer;//IR layer id of the current workload
   bool _wl_end;//all workloads are end
   bool _overall_end;//all data sending end
   int _end_time;
@@ -119,7 +123,7 @@ private:
  // std::unordered_map<int,int> wl_map;
   //for loading data (double ckeck)
   unordered_map<int,int> _rq_to_sent;//transfer_id,layer_num
-  unordered_map<int, pair<unordered_set<string>,vector<int>>> _s_rq_list;//sent_request;the length of the vector is 3, 1st is core_id, 2nd is size, 3rd is number of received end (ddr is >=1)
+  unordered_map<int, pair<unordered_set<int>,vector<int>>> _s_rq_list;//sent_request;the length of the vector is 3, 1st is core_id, 2nd is size, 3rd is number of received end (ddr is >=1)
  // unordered_map<int, int>_r_data_list;//receive_data_size;Each entry is decremented and should end up at 0
   //for sending data
   //unordered_map<int, unordered_set<int>> _r_rq_list;//received_request,first int is transfer_idset is core list.(unicast has 1 entry, multicast has multiple entry)
@@ -128,15 +132,15 @@ private:
   unordered_map<int, int>_send_data_list;//transfer id, data to sent;
   //unordered_map<int, int> _s_data_list;//sending_data; no need to distinguish unicast and multicast
   //for buffer record
-  unordered_map<string, unordered_set<int>> _core_buffer;//layername,corresponding transfer
+  unordered_map<int, unordered_set<int>> _core_buffer;//IR layer id,corresponding transfer
   unordered_set<int>_left_data;
   vector<pair<vector<pair<vector<int>, unordered_set<int>>>,int>> o_buf;//each entry of vector is an output_buffer;
   //                                                        mini tile num
-  vector<pair<int,string>> obuf_wl_id;
+  vector<pair<int,int>> obuf_wl_id;//workload order, flit layer id
   //<transfer_id,vector<destination,size>>
   unordered_map<int, int> id_ddr_rel;//ddr relates to transfer_id
-  unordered_set<int> _watch_cores;
-  unordered_set<int> _watch_ids;
+  bool _watched;//this core is listed in watch_cores
+  WatchList _watch_ids;
   // signal
   vector<int>_end_message;
   bool _wl_fn;//workload finish
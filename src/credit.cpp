@@ -32,9 +32,9 @@
 
 #include "booksim.hpp"
 #include "credit.hpp"
+#include "thread_pool.hpp"
 
-stack<Credit *> Credit::_all;
-stack<Credit *> Credit::_free;
+static SlabPool<Credit> _pool;
 
 Credit::Credit()
 {
@@ -43,37 +43,35 @@ Credit::Credit()
 
 void Credit::Reset()
 {
-  vc.clear();
+  vc_mask = 0;
   head = false;
   tail = false;
   id   = -1;
 }
 
 Credit * Credit::New() {
-  Credit * c;
-  if(_free.empty()) {
-    c = new Credit();
-    _all.push(c);
-  } else {
-    c = _free.top();
-    c->Reset();
-    _free.pop();
-  }
+  Credit * const c = _pool.Get();
+  c->Reset();
   return c;
 }
 
 void Credit::Free() {
-  _free.push(this);
+  _pool.Put(this);
 }
 
 void Credit::FreeAll() {
-  while(!_all.empty()) {
-    delete _all.top();
-    _all.pop();
-  }
+  _pool.Clear();
 }
 
 
 int Credit::OutStanding(){
-  return _all.size()-_free.size();
+  return _pool.Live();
+}
+
+void Credit::TrimPool() {
+  _pool.Trim();
+}
+
+void Credit::DisplayPool( ostream & os ) {
+  _pool.Display(os, "Credit");
 }
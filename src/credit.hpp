@@ -28,14 +28,37 @@
 #ifndef _CREDIT_HPP_
 #define _CREDIT_HPP_
 
-#include <set>
-#include <stack>
+#include <cassert>
+#include <iostream>
+
+#include "slab_pool.hpp"
 
 class Credit {
 
 public:
 
-  set<int> vc;
+  // VCs are carried as a bit mask, so a credit can name at most MAX_VCS
+  static const int MAX_VCS = 64;
+
+  unsigned long long vc_mask;
+
+  void AddVC( int vc )
+  {
+    assert( ( vc >= 0 ) && ( vc < MAX_VCS ) );
+    vc_mask |= 1ULL << vc;
+  }
+  bool HasVCs( ) const { return vc_mask != 0; }
+  int NumVCs( ) const { return __builtin_popcountll( vc_mask ); }
+  // lowest VC in the credit / next VC after 'vc', -1 if there is none
+  int FirstVC( ) const { return vc_mask ? __builtin_ctzll( vc_mask ) : -1; }
+  int NextVC( int vc ) const
+  {
+    if ( vc + 1 >= MAX_VCS ) {
+      return -1;
+    }
+    unsigned long long const rest = vc_mask & ( ~0ULL << ( vc + 1 ) );
+    return rest ? __builtin_ctzll( rest ) : -1;
+  }
 
   // these are only used by the event router
   bool head, tail;
@@ -47,10 +70,12 @@ public:
   void Free();
   static void FreeAll();
   static int OutStanding();
+  // returns idle slabs of the credit pool to the system
+  static void TrimPool();
+  static void DisplayPool( ostream & os );
 private:
 
-  static stack<Credit *> _all;
-  static stack<Credit *> _free;
+  friend class SlabPool<Credit>;
 
   Credit();
   ~Credit() {}
@@ -53,11 +53,13 @@ todo:
 #else
 #include <assert.h>
 #endif // #ifdef NDEBUG
+#include <limits>
+
 #include "booksim.hpp"
 #include "ddr.hpp"
 
 
-DDR::DDR(const Configuration& config, vector<int>& ddr_routers, int id, const nlohmann::json &j)
+DDR::DDR(const Configuration& config, vector<int>& ddr_routers, int id, const WorkloadIR& ir)
 {
 	_time = -1;
 	_ddr_num = config.GetInt("DDR_num");
@@ -80,51 +82,53 @@ DDR::DDR(const Configuration& config, vector<int>& ddr_routers, int id, const nl
 	vector<int> temp = config.GetIntArray("watch_cores");
 	if (config.GetInt("watch_all_cores")) {
 		for (int i = 0; i < config.GetInt("k") * config.GetInt("k"); i++) {
-			_watch_cores.insert(i);
+			_watch_cores.Insert(i);
 		}
 
 	}
 	else {
 		for (auto x : temp) {
-			_watch_cores.insert(x);
+			_watch_cores.Insert(x);
 		}
 	}
 	vector<int> temp1 = config.GetIntArray("watch_transfer_id");
 	for (auto x : temp1) {
-		_watch_ids.insert(x);
+		_watch_ids.Insert(x);
 	}
-	for (auto& x : j[to_string(-1)]["in"]) {
-			for (auto& y : x["related_ofmap"]) {
-				_ifm_to_ofm[x["transfer_id"]].insert(y.get<int>());
-			}
+	for (int i = 0; i < ir.NumDdrIns(); i++) {
+		const WorkloadIR::DdrIn& x = ir.GetDdrIn(i);
+		for (int r = x.related_begin; r < x.related_end; r++) {
+			_ifm_to_ofm[x.transfer_id].insert(ir.GetDdrId(r));
+		}
 	}
-	for (auto& x : j[to_string(-1)]["out"]) {
-		cout << x["transfer_id"] << "\n";
-		_ofm_message[x["transfer_id"]].first.first.resize(3);
-		_ofm_message[x["transfer_id"]].first.first[0] = x["related_ifmap"].size();
+	for (int i = 0; i < ir.NumDdrOuts(); i++) {
+		const WorkloadIR::DdrOut& x = ir.GetDdrOut(i);
+		cout << x.transfer_id << "\n";
+		pair<pair<vector<int>, int>, vector<int>>& message = _ofm_message[x.transfer_id];
+		message.first.first.resize(3);
+		message.first.first[0] = x.related_ifmaps;
 		if (_ddr_id != _ddr_num) {
-			_ofm_message[x["transfer_id"]].first.first[1] = x["size"].get<int>()/_ddr_num;
+			message.first.first[1] = x.size / _ddr_num;
 		}
 		else {
-			_ofm_message[x["transfer_id"]].first.first[1] = x["size"].get<int>() / _ddr_num + x["size"].get<int>() % _ddr_num;
+			message.first.first[1] = x.size / _ddr_num + x.size % _ddr_num;
 		}
-		_ofm_message[x["transfer_id"]].first.first[2] = x["destination"].size();
-		_ofm_message[x["transfer_id"]].first.second = x["layer_name"];
+		message.first.second = ir.FlitLayer(x.layer);
 
-		_ofm_message[x["transfer_id"]].second.reserve(x["destination"].size());
+		message.second.reserve(x.dest_end - x.dest_begin);
 		unordered_set<int> temp_dest;
-		for (auto& y : x["destination"]) {
-			temp_dest.insert(y["id"].get<int>());
+		for (int d = x.dest_begin; d < x.dest_end; d++) {
+			temp_dest.insert(ir.GetDdrId(d));
 		}
-		_ofm_message[x["transfer_id"]].first.first[2] = temp_dest.size();
+		message.first.first[2] = temp_dest.size();
 		for (auto& y : temp_dest) {
-			_ofm_message[x["transfer_id"]].second.push_back(y);
+			message.second.push_back(y);
 		}
 	}
 }  
 
 
-void DDR::run(int time, vector<int>& empty_router, int router_id, bool _empty,bool time_emty, list<Flit*>& _flits_sending) {
+void DDR::run(int time, vector<int>& empty_router, int router_id, bool _empty,bool time_emty, vector<Flit*>& _flits_sending) {
 //	receive_message(f);
 	_time = time;
 	bool temp_send = (!_packet_to_send.empty() || !_data_to_send.empty()) && _empty;
@@ -252,11 +256,32 @@ void DDR::run(int time, vector<int>& empty_router, int router_id, bool _empty,bo
 
 
 
+//_time_cnt is decremented once per cycle while it is non-zero; the DDR can only
+//grant or drain again in the cycle where it reaches zero.
+int DDR::next_event(int time) const {
+	bool pending_send = !_packet_to_send.empty() || !_data_to_send.empty();
+	if (_fifo_data.empty() && !pending_send) {
+		return numeric_limits<int>::max();
+	}
+	if (pending_send && _grant_router != -1) {
+		return time;
+	}
+	if (_time_cnt == 0) {
+		return time;
+	}
+	return time + _time_cnt - 1;
+}
+
+void DDR::fast_forward(int cycles) {
+	assert(cycles >= 0);
+	_time_cnt = _time_cnt > cycles ? _time_cnt - cycles : 0;
+}
+
 void DDR::receive_message(Flit*f) {
 	assert(f->tail);//For request, head is tail ; For data, after tail comes, update buffer.
 	if (f->nn_type == 5) {
 		
-		if (_watch_cores.count(f->src)>0 || _watch_ids.count(f->transfer_id)>0) {
+		if (_watch_cores.Contains(f->src) || _watch_ids.Contains(f->transfer_id)) {
 			cout << "this DDR is = " << _ddr_id << " receive requirement transfer_id " << f->transfer_id << " src= " << f->src << " inject time = " << f->ctime << "\n";
 		}
 
@@ -271,7 +296,7 @@ void DDR::receive_message(Flit*f) {
 		}
 	}
 	if (f->nn_type == 6 ) {
-//		if (_watch_ids.count(f->transfer_id) > 0) {
+//		if (_watch_ids.Contains(f->transfer_id)) {
 //			cout << " this DDR is = " << _ddr_id << " receive transfer_id " << f->transfer_id << " receive flit " << f->id << " size is = " << f->size << "\n";
 //		}
 //		cout << "this DDR is = " << _ddr_id << " receive transfer_id " << f->transfer_id << " src= " << f->src << " inject time = " << f->ctime << "\n";
@@ -284,14 +309,14 @@ void DDR::receive_message(Flit*f) {
 		}
 		if (f->end) {
 			_end_set.insert(f->transfer_id);
-			if (_watch_cores.count(f->src) > 0 || _watch_ids.count(f->transfer_id) > 0) {
+			if (_watch_cores.Contains(f->src) || _watch_ids.Contains(f->transfer_id)) {
 				cout << "this DDR is = " << _ddr_id << " receive end transfer_id " << f->transfer_id << " src= " << f->src << " inject time = " << f->ctime << "\n";
 			}
 		}
 	}
 	/*
 	if (f->nn_type == 6 && f->end) {
-		if (_watch_cores.count(f->src) > 0 || _watch_ids.count(f->transfer_id) > 0) {
+		if (_watch_cores.Contains(f->src) || _watch_ids.Contains(f->transfer_id)) {
 			cout << "this DDR is = " << _ddr_id << " receive end transfer_id " << f->transfer_id << " src= " << f->src << " inject time = " << f->ctime << "\n";
 		}
 //		unordered_set<int> temp=_ifm_to_ofm[f->transfer_id];
@@ -313,9 +338,10 @@ void DDR::receive_message(Flit*f) {
 
 }
 
-void DDR::_send_data(list<Flit*>& _flits_sending) {
+void DDR::_send_data(vector<Flit*>& _flits_sending) {
 	int flits = (_packet_to_send.front().first.second.first[1] - 1) / _flit_width + 1;//data part, need to add head fli
 	int mflag_tmp = false;
+	int layer = _packet_to_send.front().first.second.second;
 	for (int i = 0; i < flits + 1; i++) {
 		Flit* f = Flit::New();
 		f->nn_type = 6;
@@ -323,7 +349,7 @@ void DDR::_send_data(list<Flit*>& _flits_sending) {
 		f->ctime = _time;
 		f->tail = i == (flits) ? true : false;
 		f->size = _packet_to_send.front().first.second.first[1];
-		f->layer_name = _packet_to_send.front().first.second.second;
+		f->layer = layer;
 		f->transfer_id = _packet_to_send.front().first.second.first[0];
 		f->mflag = mflag_tmp;
 		f->end = _packet_to_send.front().first.first;
@@ -333,7 +359,9 @@ void DDR::_send_data(list<Flit*>& _flits_sending) {
 			if (_packet_to_send.front().second.size() > 1) {
 				f->mflag = true;
 				mflag_tmp = true;
-				f->mdest.first = _packet_to_send.front().second;
+				for (auto& x : _packet_to_send.front().second) {
+					f->MutableMdest().first.Insert(x);
+				}
 			}
 			else {
 				f->dest = _packet_to_send.front().second[0];
@@ -341,7 +369,7 @@ void DDR::_send_data(list<Flit*>& _flits_sending) {
 		}
 		_flits_sending.push_back(f);
 	}
-	if (_watch_ids.count(_packet_to_send.front().first.second.first[0]) > 0 && _packet_to_send.front().first.first ) {
+	if (_watch_ids.Contains(_packet_to_send.front().first.second.first[0]) && _packet_to_send.front().first.first ) {
 		cout << "this ddr is = " << _ddr_id << " send_end_transfer = "<< _packet_to_send.front().first.second.first[0]<< " at time " << _time << "\n";
 	}
 	/*
@@ -44,31 +44,34 @@
 #include "booksim.hpp"
 #include "config_utils.hpp"
 #include "flit.hpp"
-#include "json.hpp"
+#include "watch_list.hpp"
+#include "workload_ir.hpp"
 using namespace std;
 
 class DDR {
 
 public:
-	void run(int time, vector<int>& empty_router, int router_id, bool empty,bool time_empty, list<Flit*>& _flits_sending);
+	void run(int time, vector<int>& empty_router, int router_id, bool empty,bool time_empty, vector<Flit*>& _flits_sending);
 
 
-void _send_data(list<Flit*>& _flits_sending);
+void _send_data(vector<Flit*>& _flits_sending);
+int next_event(int time) const;//earliest cycle >= time at which run() acts, assuming idle routers
+void fast_forward(int cycles);//account for cycles in which run() was not called
 //Flit* send_requirement();
 void receive_message(Flit*f);
-DDR(const Configuration& config,vector<int>& ddr_routers, int id, const nlohmann::json& j);
+DDR(const Configuration& config,vector<int>& ddr_routers, int id, const WorkloadIR& ir);
 ~DDR() {};
 private:
 	unordered_set<int> _r_ts_list;//received transfer
 	unordered_map<int,int> _r_rq_list;//received requirest
 	unordered_set<int> _ready_list;//ready ofmaps
 	//When the new data is ready, add to _data_to_send first, wait for _packet_to_send to be empty, and then load the one packet to _packet_to_send
-	deque<pair<pair<vector<int>, string>,vector<int>>> _data_to_send;//all data
-	deque<pair<pair<bool,pair<vector<int>, string>>, vector<int>>> _packet_to_send;//packets_to_send. size is one packet of data. 1st int is end singnal
+	deque<pair<pair<vector<int>, int>,vector<int>>> _data_to_send;//all data, the int is the flit layer id
+	deque<pair<pair<bool,pair<vector<int>, int>>, vector<int>>> _packet_to_send;//packets_to_send. size is one packet of data. 1st int is end singnal
 	unordered_map<int, unordered_set<int>> _ifm_to_ofm;
-	unordered_map<int, pair<pair<vector<int>,string>,vector<int>>> _ofm_message;
-	unordered_set<int> _watch_cores;
-	unordered_set<int> _watch_ids;
+	unordered_map<int, pair<pair<vector<int>,int>,vector<int>>> _ofm_message;
+	WatchList _watch_cores;
+	WatchList _watch_ids;
 	//int1 is output transfer id, int 2 is input transfer number, int3 ofmap size, int4 destination number
 	int _ddr_id;
 	int _ddr_num;
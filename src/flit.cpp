@@ -36,9 +36,21 @@
 
 #include "booksim.hpp"
 #include "flit.hpp"
+#include "thread_pool.hpp"
 
-stack<Flit *> Flit::_all;
-stack<Flit *> Flit::_free;
+#include <cassert>
+#include <mutex>
+#include <unordered_map>
+
+static SlabPool<Flit> _pool;
+stack<Flit::McastDest *> Flit::_free_mdest;
+const Flit::McastDest Flit::_no_mdest;
+// layer names are interned once so that flits carry a plain id; id 0 is ""
+static vector<string> _layer_names(1);
+static unordered_map<string, int> _layer_ids = { { "", 0 } };
+// multicast destination sets are shared between the routers stepped by a
+// ThreadPool
+static mutex _pool_lock;
 
 ostream& operator<<( ostream& os, const Flit& f )
 {
@@ -55,6 +67,7 @@ ostream& operator<<( ostream& os, const Flit& f )
 
 Flit::Flit() 
 {  
+  mdest = 0;
   Reset();
 }  
 
@@ -94,31 +107,78 @@ void Flit::Reset()
   inter_dest = -1; // Bransan added
   mflag = false;
   from_ddr = false;
-  layer_name = "";
-  mdest.first={};
-  mdest.second = {};
+  layer = 0;
+  assert(!mdest);
 }  
 
-Flit * Flit::New() {
-  Flit * f;
-  if(_free.empty()) {
-    f = new Flit;
-    _all.push(f);
-  } else {
-    f = _free.top();
-    f->Reset();
-    _free.pop();
+Flit::McastDest & Flit::MutableMdest()
+{
+  if(!mdest) {
+    unique_lock<mutex> lock(_pool_lock, defer_lock);
+    if(ThreadPool::Parallel()) {
+      lock.lock();
+    }
+    if(_free_mdest.empty()) {
+      mdest = new McastDest;
+    } else {
+      mdest = _free_mdest.top();
+      _free_mdest.pop();
+    }
   }
+  return *mdest;
+}
+
+int Flit::InternLayer( const string & name )
+{
+  unordered_map<string, int>::const_iterator iter = _layer_ids.find(name);
+  if(iter != _layer_ids.end()) {
+    return iter->second;
+  }
+  int const layer = _layer_names.size();
+  _layer_names.push_back(name);
+  _layer_ids[name] = layer;
+  return layer;
+}
+
+const string & Flit::LayerName( int layer )
+{
+  assert((layer >= 0) && (layer < (int)_layer_names.size()));
+  return _layer_names[layer];
+}
+
+Flit * Flit::New() {
+  Flit * const f = _pool.Get();
+  f->Reset();
   return f;
 }
 
 void Flit::Free() {
-  _free.push(this);
+  if(mdest) {
+    unique_lock<mutex> lock(_pool_lock, defer_lock);
+    if(ThreadPool::Parallel()) {
+      lock.lock();
+    }
+    // keep the allocated words for the next multicast head
+    mdest->first.Clear();
+    mdest->second.Clear();
+    _free_mdest.push(mdest);
+    mdest = 0;
+  }
+  _pool.Put(this);
 }
 
 void Flit::FreeAll() {
-  while(!_all.empty()) {
-    delete _all.top();
-    _all.pop();
+  _pool.Clear();
+  while(!_free_mdest.empty()) {
+    delete _free_mdest.top();
+    _free_mdest.pop();
   }
 }
+
+void Flit::TrimPool() {
+  _pool.Trim();
+}
+
+void Flit::DisplayPool( ostream & os ) {
+  _pool.Display(os, "Flit");
+}
@@ -30,20 +30,21 @@
 
 #include <iostream>
 #include <stack>
+#include <string>
 #include <vector>
 #include <utility>
 
 #include "booksim.hpp"
 #include "outputset.hpp"
+#include "nodeset.hpp"
+#include "slab_pool.hpp"
 
 class Flit {
 
 public:
 
-
-  pair < vector <int> , vector <int> >  mdest;
-
-  bool mflag;
+  // multicast destinations: wired list first, wireless list second
+  typedef pair < NodeSet , NodeSet > McastDest;
 
   const static int NUM_FLIT_TYPES = 7;
   enum FlitType { READ_REQUEST  = 0, //5,6 ARE FOR DNN ACCELERATORS
@@ -53,49 +54,44 @@ public:
                   ANY_TYPE      = 4, 
           REQUEST = 5,
           DATA = 6};
-  FlitType type;
-
-  int vc;
-  int flits_num;
-  int nn_type;//5 is request, 6 is data
-
-  int cl;
-  int layer_num;
-  bool head;
-  bool tail;
-  
-  int  ctime;//create time
-  int  itime;//inject time
-  int  atime;//arrival time
 
-  int cur_router;
+  // fields touched by the router pipeline on every hop come first so that
+  // they share a cache line
   int  id;
   int  pid;
-  int  oid; //Bransan added to calculate transaction time for multicast
-  int  transfer_id;
-  bool end;//for data, record whether this packet is the end of the whole transfer.
-  string layer_name;
-
-  bool record;
-
+  int  vc;
   int  src;
   int  dest;
-
-  int size;// record the size of the packet to transfer
-
+  int  inter_dest;
   int  pri;
   int  hops;
-  bool watch;
+  int  cur_router;
   int  subnetwork;
+  FlitType type;
 
-  //Bransan added dropped status
-  bool dropped;
-
+  bool head;
+  bool tail;
+  bool mflag;
+  bool watch;
+  bool record;
+  bool dropped; //Bransan added dropped status
+  bool end;//for data, record whether this packet is the end of the whole transfer.
   bool from_ddr;
   bool to_ddr;
 
-  int inter_dest;
-  
+  int  ctime;//create time
+  int  itime;//inject time
+  int  atime;//arrival time
+
+  int  oid; //Bransan added to calculate transaction time for multicast
+  int  cl;
+  int  flits_num;
+  int  nn_type;//5 is request, 6 is data
+  int  layer_num;
+  int  layer;//interned layer name, see LayerName()
+  int  transfer_id;
+  int  size;// record the size of the packet to transfer
+
   // intermediate destination (if any)
   mutable int intm;
 
@@ -105,22 +101,38 @@ public:
   // Fields for arbitrary data
   void* data ;
 
+  // multicast destinations, only allocated for multicast head flits
+  McastDest * mdest;
+
   // Lookahead route info
   OutputSet la_route_set;
 
   void Reset();
 
+  // read-only view of the multicast destinations (empty if none)
+  const McastDest & GetMdest() const { return mdest ? *mdest : _no_mdest; }
+  // multicast destinations for writing, allocated on first use
+  McastDest & MutableMdest();
+
+  static int InternLayer( const string & name );
+  static const string & LayerName( int layer );
+
   static Flit * New();
   void Free();
   static void FreeAll();
+  // returns idle slabs of the flit pool to the system
+  static void TrimPool();
+  static void DisplayPool( ostream & os );
 
 private:
 
+  friend class SlabPool<Flit>;
+
   Flit();
-  ~Flit() {}
+  ~Flit() { delete mdest; }
 
-  static stack<Flit *> _all;
-  static stack<Flit *> _free;
+  static stack<McastDest *> _free_mdest;
+  static const McastDest _no_mdest;
 
 };
 
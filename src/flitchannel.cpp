@@ -64,25 +64,20 @@ void FlitChannel::SetSink(Router const * const router, int port) {
 void FlitChannel::Send(Flit * f) {
   if(f) {
     ++_active[f->cl];
+    if(f->watch) {
+      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
+		 << "Beginning channel traversal for flit " << f->id
+		 << " with delay " << _delay
+		 << "." << endl;
+    }
   } else {
     ++_idle;
   }
   Channel<Flit>::Send(f);
 }
 
-void FlitChannel::ReadInputs() {
-  Flit const * const & f = _input;
-  if(f && f->watch) {
-    *gWatchOut << GetSimTime() << " | " << FullName() << " | "
-	       << "Beginning channel traversal for flit " << f->id
-	       << " with delay " << _delay
-	       << "." << endl;
-  }
-  Channel<Flit>::ReadInputs();
-}
-
-void FlitChannel::WriteOutputs() {
-  Channel<Flit>::WriteOutputs();
+void FlitChannel::Deliver() {
+  Channel<Flit>::Deliver();
   if(_output && _output->watch) {
     *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 	       << "Completed channel traversal for flit " << _output->id
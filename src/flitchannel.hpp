@@ -75,8 +75,7 @@ public:
   // Send flit 
   virtual void Send(Flit * flit);
 
-  virtual void ReadInputs();
-  virtual void WriteOutputs();
+  virtual void Deliver();
 
 private:
   
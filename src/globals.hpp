@@ -33,6 +33,7 @@
 #include <map>
 #include <list>
 #include <utility>
+#include <atomic>
 
 #include "flit.hpp"
 
@@ -48,8 +49,8 @@ extern bool gPrintActivity;
 
 extern int mcastcount;
 extern int total_count;
-extern int wiredcount;
-extern int wirelesscount;
+extern std::atomic<int> wiredcount; // bumped by routing functions, see sim_threads
+extern std::atomic<int> wirelesscount;
 extern int non_mdnd_hops;
 extern int latest_mdnd_hop;
 
@@ -0,0 +1,73 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*ir_convert.cpp
+ *
+ *Converts a JSON workload IR into the binary form of WorkloadIR, which
+ *the simulator maps instead of parsing (set ir_file to the output).
+ *
+ *Build with "make booksim-ir-convert" and run
+ *./booksim-ir-convert IR.json IR.irb
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "workload_ir.hpp"
+
+using namespace std;
+
+int main( int argc, char ** argv )
+{
+  if ( argc != 3 ) {
+    cerr << "usage: " << argv[0] << " <ir.json> <ir.irb>" << endl;
+    return 1;
+  }
+
+  WorkloadIR ir;
+  string error;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now( );
+  if ( !ir.Load( argv[1], error ) ) {
+    cerr << "Cannot load workload IR " << argv[1] << ": " << error << endl;
+    return 1;
+  }
+  double const load_ms = chrono::duration<double, milli>( chrono::steady_clock::now( ) - start ).count( );
+
+  start = chrono::steady_clock::now( );
+  if ( !ir.Save( argv[2], error ) ) {
+    cerr << "Cannot save workload IR " << argv[2] << ": " << error << endl;
+    return 1;
+  }
+  double const save_ms = chrono::duration<double, milli>( chrono::steady_clock::now( ) - start ).count( );
+
+  cout << argv[1] << ": " << ir.TotalWorkloads( ) << " workloads on " << ir.NumCores( )
+       << " core ids, " << ir.NumDdrIns( ) << " DDR in / " << ir.NumDdrOuts( ) << " DDR out transfers, "
+       << ir.NumLayers( ) << " layers, loaded in " << load_ms << " ms" << endl;
+  cout << argv[2] << ": " << ( ir.Bytes( ) + 1023 ) / 1024 << " KB, written in " << save_ms << " ms" << endl;
+  return 0;
+}
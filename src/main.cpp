@@ -104,8 +104,8 @@ int total_ucast_hops = 0;
 
 int mcastcount = 0;
 int total_count = 0;
-int wirelesscount = 0;
-int wiredcount = 0;
+atomic<int> wirelesscount(0);
+atomic<int> wiredcount(0);
 int non_mdnd_hops = 0;
 int latest_mdnd_hop = 0;
 //Bransan map declare
@@ -160,6 +160,7 @@ bool Simulate( BookSimConfig const & config )
     name << "network_" << i;
     net[i] = Network::New( config, name.str() );
   }
+  BuildRoutingTables( config );
 
   /*tcc and characterize are legacy
    *not sure how to use them 
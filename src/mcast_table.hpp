@@ -0,0 +1,109 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*mcast_table.hpp
+ *
+ *Replication state of the multicast packet at the front of a VC: for each
+ *output port the packet is copied to, the destinations that copy has to
+ *reach. Storage is one entry per output port, allocated once, so filling
+ *and clearing the table for every packet does not touch the heap.
+ */
+
+#ifndef _MCAST_TABLE_HPP_
+#define _MCAST_TABLE_HPP_
+
+#include <vector>
+#include <cassert>
+
+#include "flit.hpp"
+#include "nodeset.hpp"
+
+using namespace std;
+
+class McastTable {
+
+public:
+  McastTable( ) : _ports(0) {}
+
+  void Resize( int outputs )
+  {
+    _dests.resize( outputs );
+    _used.resize( outputs, false );
+  }
+
+  void Add( int port, const NodeSet & dests, bool wireless )
+  {
+    assert( ( port >= 0 ) && ( port < (int)_dests.size( ) ) );
+    if ( !_used[port] ) {
+      _used[port] = true;
+      ++_ports;
+    }
+    if ( wireless ) {
+      _dests[port].second |= dests;
+    } else {
+      _dests[port].first |= dests;
+    }
+  }
+
+  void Clear( )
+  {
+    for ( int port = FirstPort( ); port >= 0; port = NextPort( port ) ) {
+      _dests[port].first.Clear( );
+      _dests[port].second.Clear( );
+      _used[port] = false;
+    }
+    _ports = 0;
+  }
+
+  // number of output ports the packet is replicated to
+  int NumPorts( ) const { return _ports; }
+
+  // output ports in use, in ascending order; -1 if there is none
+  int FirstPort( ) const { return NextPort( -1 ); }
+  int NextPort( int port ) const
+  {
+    for ( ++port; port < (int)_used.size( ); ++port ) {
+      if ( _used[port] ) {
+        return port;
+      }
+    }
+    return -1;
+  }
+
+  const Flit::McastDest & Dests( int port ) const
+  {
+    assert( ( port >= 0 ) && ( port < (int)_dests.size( ) ) && _used[port] );
+    return _dests[port];
+  }
+
+private:
+  vector<Flit::McastDest> _dests;
+  vector<bool> _used;
+  int _ports;
+};
+
+#endif
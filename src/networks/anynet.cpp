@@ -55,8 +55,13 @@
 #include <sstream>
 #include <limits>
 #include <algorithm>
+#include <queue>
+#include <thread>
+#include <atomic>
+#include <cstdio>
 //this is a hack, I can't easily get the routing talbe out of the network
-map<int, int>* global_routing_table;
+int* global_routing_table;
+int global_routing_nodes;
 
 AnyNet::AnyNet( const Configuration &config, const string & name )
   :  Network( config, name ){
@@ -83,8 +88,35 @@ void AnyNet::_ComputeSize( const Configuration &config ){
     cout<<"No network file name provided"<<endl;
     exit(-1);
   }
-  //parse the network description file
-  readFile();
+  route_threads = config.GetInt("route_threads");
+
+  ifstream network_list(file_name.c_str(), ios::binary);
+  if(!network_list.is_open()){
+    cout<<"Anynet:can't open network file "<<file_name<<endl;
+    exit(-1);
+  }
+  ostringstream contents;
+  contents<<network_list.rdbuf();
+
+  //FNV-1a of the file contents, a cache built from other contents is stale
+  file_hash = 14695981039346656037ULL;
+  string const & text = contents.str();
+  for(size_t i = 0; i < text.size(); i++){
+    file_hash = (file_hash ^ (unsigned char)text[i]) * 1099511628211ULL;
+  }
+
+  cache_name = config.GetStr("network_cache");
+  if(cache_name == ""){
+    cache_name = file_name + ".cache";
+  } else if(cache_name == "-"){
+    cache_name = "";
+  }
+
+  //parse the network description file, unless the cache has it already
+  table_cached = !cache_name.empty() && readCache();
+  if(!table_cached){
+    readFile(text);
+  }
 
   _channels =0;
   cout<<"========================Network File Parsed=================\n";
@@ -202,7 +234,14 @@ void AnyNet::_BuildNet( const Configuration &config ){
     }
   }
 
-  buildRoutingTable();
+  if(!table_cached){
+    buildRoutingTable();
+    if(!cache_name.empty()){
+      writeCache();
+    }
+  }
+  global_routing_table = &routing_table[0];
+  global_routing_nodes = _nodes;
 
 }
 
@@ -215,8 +254,8 @@ void min_anynet( const Router *r, const Flit *f, int in_channel,
 		 OutputSet *outputs, bool inject ){
   int out_port=-1;
   if(!inject){
-    assert(global_routing_table[r->GetID()].count(f->dest)!=0);
-    out_port=global_routing_table[r->GetID()][f->dest];
+    out_port=global_routing_table[r->GetID() * global_routing_nodes + f->dest];
+    assert(out_port>=0);
   }
  
 
@@ -242,88 +281,232 @@ void min_anynet( const Router *r, const Flit *f, int in_channel,
 
 void AnyNet::buildRoutingTable(){
   cout<<"========================== Routing table  =====================\n";  
-  routing_table.resize(_size);
-  for(int i = 0; i<_size; i++){
-    route(i);
+
+  //flatten the maps once so the searches below only read plain arrays:
+  //router to router links (neighbor, latency) with the output port used,
+  //and the nodes of each router with their ejection port
+  vector<int> adj_start(_size+1, 0);
+  vector<pair<int,int> > adj;
+  vector<int> adj_port;
+  vector<int> node_start(_size+1, 0);
+  vector<pair<int,int> > node_port;
+  for(int r = 0; r<_size; r++){
+    map<int, pair<int,int> > const & links = router_list[1][r];
+    for(map<int, pair<int,int> >::const_iterator iter = links.begin();
+	iter!=links.end();
+	iter++){
+      adj.push_back(make_pair(iter->first, iter->second.second));
+      adj_port.push_back(iter->second.first);
+    }
+    adj_start[r+1] = adj.size();
+    map<int, pair<int,int> > const & nodes = router_list[0][r];
+    for(map<int, pair<int,int> >::const_iterator iter = nodes.begin();
+	iter!=nodes.end();
+	iter++){
+      node_port.push_back(make_pair(iter->first, iter->second.first));
+    }
+    node_start[r+1] = node_port.size();
+  }
+
+  routing_table.assign(_size * _nodes, -1);
+
+  //one single-source search per router, handed out to the threads in turn
+  int threads = route_threads;
+  if(threads <= 0){
+    threads = thread::hardware_concurrency();
+  }
+  threads = max(1, min(threads, _size));
+  atomic<int> next_router(0);
+  auto work = [&](){
+    vector<int> dist(_size);
+    vector<int> first_hop(_size);
+    for(int r = next_router++; r < _size; r = next_router++){
+      route(r, adj_start, adj, adj_port, node_start, node_port, dist, first_hop);
+    }
+  };
+  vector<thread> workers;
+  for(int t = 1; t < threads; t++){
+    workers.push_back(thread(work));
+  }
+  work();
+  for(size_t t = 0; t < workers.size(); t++){
+    workers[t].join();
   }
-  global_routing_table = &routing_table[0];
 }
 
 
 //11/7/2012
 //basically djistra's, tested on a large dragonfly anynet configuration
-void AnyNet::route(int r_start){
-  int* dist = new int[_size];
-  int* prev = new int[_size];
-  set<int> rlist;
-  for(int i = 0; i<_size; i++){
-    dist[i] =  numeric_limits<int>::max();
-    prev[i] = -1;
-    rlist.insert(i);
-  }
+//now with a binary heap; routers are settled in (distance, id) order, the
+//same order the original linear scan picked them in, so ties resolve the
+//same way. first_hop holds the index of the r_start link each router is
+//reached through.
+void AnyNet::route(int r_start, vector<int> const &adj_start,
+		   vector<pair<int,int> > const &adj, vector<int> const &adj_port,
+		   vector<int> const &node_start, vector<pair<int,int> > const &node_port,
+		   vector<int> &dist, vector<int> &first_hop){
+  fill(dist.begin(), dist.end(), numeric_limits<int>::max());
+  fill(first_hop.begin(), first_hop.end(), -1);
+  priority_queue<pair<int,int>, vector<pair<int,int> >, greater<pair<int,int> > > rlist;
   dist[r_start] = 0;
+  rlist.push(make_pair(0, r_start));
   while(!rlist.empty()){
     //find min 
-    int min_dist = numeric_limits<int>::max();
-    int min_cand = -1;
-    for(set<int>::iterator i = rlist.begin();
-	i!=rlist.end();
-	i++){
-      if(dist[*i]<min_dist){
-	min_dist = dist[*i];
-	min_cand = *i;
-      }
+    int const min_dist = rlist.top().first;
+    int const min_cand = rlist.top().second;
+    rlist.pop();
+    if(min_dist > dist[min_cand]){
+      continue; //already settled through a shorter path
     }
-    rlist.erase(min_cand);
 
     //neighbor
-    for(map<int,pair<int,int> >::iterator i = router_list[1][min_cand].begin(); 
-	i!=router_list[1][min_cand].end(); 
-	i++){
-      int new_dist = dist[min_cand] + i->second.second;//distance is hops not cycles
-      if(new_dist < dist[i->first]){
-	dist[i->first] = new_dist;
-	prev[i->first] = min_cand;
+    for(int a = adj_start[min_cand]; a < adj_start[min_cand+1]; a++){
+      int const neighbor = adj[a].first;
+      int new_dist = min_dist + adj[a].second;//distance is hops not cycles
+      if(new_dist < dist[neighbor]){
+	dist[neighbor] = new_dist;
+	first_hop[neighbor] = (min_cand == r_start) ? a : first_hop[min_cand];
+	rlist.push(make_pair(new_dist, neighbor));
       }
     }
   }
   
-  //post process from the prev list
+  //post process from the first hops
+  int * const table = &routing_table[r_start * _nodes];
   for(int i = 0; i<_size; i++){
-    if(prev[i] ==-1){ //self
-      assert(i == r_start);
-      for(map<int, pair<int, int> >::iterator iter = router_list[0][i].begin();
-	  iter!=router_list[0][i].end();
-	  iter++){
-	routing_table[r_start][iter->first]=iter->second.first;
-	//cout<<"node "<<iter->first<<" port "<< iter->second.first<<endl;
+    if(i == r_start){ //self
+      for(int n = node_start[i]; n < node_start[i+1]; n++){
+	table[node_port[n].first] = node_port[n].second;
       }
     } else {
-      int distance=0;
-      int neighbor=i;
-      while(prev[neighbor]!=r_start){
-	assert(router_list[1][neighbor].count(prev[neighbor])>0);
-	distance+=router_list[1][prev[neighbor]][neighbor].second;//REVERSE lat
-	neighbor= prev[neighbor];
+      assert(first_hop[i] >= 0);
+      int const port = adj_port[first_hop[i]];
+      for(int n = node_start[i]; n < node_start[i+1]; n++){
+	table[node_port[n].first] = port;
       }
-      distance+=router_list[1][prev[neighbor]][neighbor].second;//lat
+    }
+  }
+}
+
+//network_cache layout, native byte order: magic and version, the hash of
+//the network file, the node to router list, the node and router link
+//lists as (head, count, (id, latency) * count), then the routing table
+static char const anynet_cache_magic[8] = {'A','N','Y','N','E','T','C','1'};
+
+bool AnyNet::readCache(){
+  FILE * cache = fopen(cache_name.c_str(), "rb");
+  if(!cache){
+    return false;
+  }
+  bool ok = true;
+  char magic[8];
+  unsigned long long hash = 0;
+  ok = ok && (fread(magic, sizeof(magic), 1, cache) == 1);
+  ok = ok && equal(magic, magic + 8, anynet_cache_magic);
+  ok = ok && (fread(&hash, sizeof(hash), 1, cache) == 1) && (hash == file_hash);
+
+  vector<int> words;
+  int count = 0;
+  ok = ok && (fread(&count, sizeof(count), 1, cache) == 1) && (count >= 0);
+  if(ok){
+    words.resize(2 * count);
+    ok = (count == 0) || (fread(&words[0], sizeof(int), words.size(), cache) == words.size());
+    for(int i = 0; ok && i < count; i++){
+      node_list[words[2*i]] = words[2*i+1];
+    }
+  }
+  for(int type = 0; ok && type < 2; type++){
+    int heads = 0;
+    ok = (fread(&heads, sizeof(heads), 1, cache) == 1);
+    for(int h = 0; ok && h < heads; h++){
+      int head[2];
+      ok = (fread(head, sizeof(int), 2, cache) == 2) && (head[1] >= 0);
+      if(!ok){
+	break;
+      }
+      map<int, pair<int,int> > & links = router_list[type][head[0]];
+      words.resize(2 * head[1]);
+      ok = (head[1] == 0) || (fread(&words[0], sizeof(int), words.size(), cache) == words.size());
+      for(int i = 0; ok && i < head[1]; i++){
+	links[words[2*i]] = pair<int,int>(-1, words[2*i+1]);
+      }
+    }
+  }
+  ok = ok && (fread(&count, sizeof(count), 1, cache) == 1) && (count > 0);
+  if(ok){
+    routing_table.resize(count);
+    ok = (fread(&routing_table[0], sizeof(int), count, cache) == (size_t)count);
+  }
+  ok = ok && (routing_table.size() == router_list[1].size() * node_list.size());
+  fclose(cache);
+
+  if(!ok){
+    cout<<"Anynet:ignoring stale or damaged network cache "<<cache_name<<endl;
+    node_list.clear();
+    router_list[0].clear();
+    router_list[1].clear();
+    routing_table.clear();
+    return false;
+  }
+  return true;
+}
 
-      assert( router_list[1][r_start].count(neighbor)!=0);
-      int port = router_list[1][r_start][neighbor].first;
-      for(map<int, pair<int,int> >::iterator iter = router_list[0][i].begin();
-	  iter!=router_list[0][i].end();
+void AnyNet::writeCache() const{
+  FILE * cache = fopen(cache_name.c_str(), "wb");
+  if(!cache){
+    cout<<"Anynet:can't write network cache "<<cache_name<<endl;
+    return;
+  }
+  vector<int> words;
+  fwrite(anynet_cache_magic, sizeof(anynet_cache_magic), 1, cache);
+  fwrite(&file_hash, sizeof(file_hash), 1, cache);
+
+  for(map<int,int>::const_iterator iter = node_list.begin();
+      iter!=node_list.end();
+      iter++){
+    words.push_back(iter->first);
+    words.push_back(iter->second);
+  }
+  int count = node_list.size();
+  fwrite(&count, sizeof(count), 1, cache);
+  if(count){
+    fwrite(&words[0], sizeof(int), words.size(), cache);
+  }
+
+  for(int type = 0; type < 2; type++){
+    int heads = router_list[type].size();
+    fwrite(&heads, sizeof(heads), 1, cache);
+    for(map<int, map<int, pair<int,int> > >::const_iterator hiter = router_list[type].begin();
+	hiter!=router_list[type].end();
+	hiter++){
+      int head[2] = {hiter->first, (int)hiter->second.size()};
+      fwrite(head, sizeof(int), 2, cache);
+      words.clear();
+      for(map<int, pair<int,int> >::const_iterator iter = hiter->second.begin();
+	  iter!=hiter->second.end();
 	  iter++){
-	routing_table[r_start][iter->first]=port;
-	//cout<<"node "<<iter->first<<" port "<< port<<" dist "<<distance<<endl;
+	words.push_back(iter->first);
+	words.push_back(iter->second.second);
+      }
+      if(!words.empty()){
+	fwrite(&words[0], sizeof(int), words.size(), cache);
       }
     }
   }
+
+  count = routing_table.size();
+  fwrite(&count, sizeof(count), 1, cache);
+  fwrite(&routing_table[0], sizeof(int), count, cache);
+  if(fclose(cache) != 0){
+    cout<<"Anynet:can't write network cache "<<cache_name<<endl;
+    remove(cache_name.c_str());
+  }
 }
 
 
-void AnyNet::readFile(){
+void AnyNet::readFile(string const &contents){
 
-  ifstream network_list;
+  istringstream network_list(contents);
   string line;
   enum ParseState{HEAD_TYPE=0,
 		  HEAD_ID,
@@ -334,12 +517,6 @@ void AnyNet::readFile(){
 		 ROUTER,
 		 UNKNOWN};
 
-  network_list.open(file_name.c_str());
-  if(!network_list.is_open()){
-    cout<<"Anynet:can't open network file "<<file_name<<endl;
-    exit(-1);
-  }
-  
   //loop through the entire file
   while(!network_list.eof()){
     getline(network_list,line);
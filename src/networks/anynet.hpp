@@ -43,14 +43,26 @@ class AnyNet : public Network {
   //[link type][src router][dest router]=(port, latency)
   vector<map<int,  map<int, pair<int,int> > > > router_list;
   //stores minimal routing information from every router to every node
-  //[router][dest_node]=port
-  vector<map<int, int> > routing_table;
+  //[router * nodes + dest_node]=port
+  vector<int> routing_table;
+
+  //network_cache file, empty if caching is disabled, and the hash of the
+  //network file contents that it must match
+  string cache_name;
+  unsigned long long file_hash;
+  bool table_cached;
+  int route_threads;
 
   void _ComputeSize( const Configuration &config );
   void _BuildNet( const Configuration &config );
-  void readFile();
+  void readFile(string const &contents);
+  bool readCache();
+  void writeCache() const;
   void buildRoutingTable();
-  void route(int r_start);
+  void route(int r_start, vector<int> const &adj_start,
+	     vector<pair<int,int> > const &adj, vector<int> const &adj_port,
+	     vector<int> const &node_start, vector<pair<int,int> > const &node_port,
+	     vector<int> &dist, vector<int> &first_hop);
 
 public:
   AnyNet( const Configuration &config, const string & name );
@@ -46,6 +46,7 @@
 #include "../random_utils.hpp"
 #include "../misc_utils.hpp"
 #include "cmesh.hpp"
+#include "../routetable.hpp"
 
 int CMesh::_cX = 0 ;
 int CMesh::_cY = 0 ;
@@ -53,6 +54,10 @@ int CMesh::_memo_NodeShiftX = 0 ;
 int CMesh::_memo_NodeShiftY = 0 ;
 int CMesh::_memo_PortShiftY = 0 ;
 
+// router x destination node -> output port for dor_cmesh or
+// dor_no_express_cmesh, whichever is in use
+static RouteTable gCMeshTable;
+
 CMesh::CMesh( const Configuration& config, const string & name ) 
   : Network(config, name) 
 {
@@ -720,6 +725,23 @@ int cmesh_next( int cur, int dest ) {
   return -1;
 }
 
+static int dor_cmesh_port( int cur_router, int dest )
+{
+  // Destination Router
+  int dest_router = CMesh::NodeToRouter( dest ) ;
+
+  if (dest_router == cur_router) {
+
+    // Forward to processing element
+    return CMesh::NodeToPort( dest ) ;
+
+  } else {
+
+    // Forward to neighbouring router
+    return cmesh_next( cur_router, dest_router );
+  }
+}
+
 void dor_cmesh( const Router *r, const Flit *f, int in_channel, 
 		OutputSet *outputs, bool inject )
 {
@@ -751,18 +773,13 @@ void dor_cmesh( const Router *r, const Flit *f, int in_channel,
     // Current Router
     int cur_router = r->GetID();
 
-    // Destination Router
-    int dest_router = CMesh::NodeToRouter( f->dest ) ;  
-  
-    if (dest_router == cur_router) {
+    if (gCMeshTable.Built()) {
 
-      // Forward to processing element
-      out_port = CMesh::NodeToPort( f->dest ) ;
+      out_port = gCMeshTable.Lookup( cur_router, f->dest );
 
     } else {
 
-      // Forward to neighbouring router
-      out_port = cmesh_next( cur_router, dest_router );
+      out_port = dor_cmesh_port( cur_router, f->dest );
     }
   }
 
@@ -804,6 +821,23 @@ int cmesh_next_no_express( int cur, int dest ) {
   return -1;
 }
 
+static int dor_no_express_cmesh_port( int cur_router, int dest )
+{
+  // Destination Router
+  int dest_router = CMesh::NodeToRouter( dest ) ;
+
+  if (dest_router == cur_router) {
+
+    // Forward to processing element
+    return CMesh::NodeToPort( dest ) ;
+
+  } else {
+
+    // Forward to neighbouring router
+    return cmesh_next_no_express( cur_router, dest_router );
+  }
+}
+
 void dor_no_express_cmesh( const Router *r, const Flit *f, int in_channel, 
 			   OutputSet *outputs, bool inject )
 {
@@ -835,18 +869,13 @@ void dor_no_express_cmesh( const Router *r, const Flit *f, int in_channel,
     // Current Router
     int cur_router = r->GetID();
 
-    // Destination Router
-    int dest_router = CMesh::NodeToRouter( f->dest ) ;  
-  
-    if (dest_router == cur_router) {
+    if (gCMeshTable.Built()) {
 
-      // Forward to processing element
-      out_port = CMesh::NodeToPort( f->dest );
+      out_port = gCMeshTable.Lookup( cur_router, f->dest );
 
     } else {
 
-      // Forward to neighbouring router
-      out_port = cmesh_next_no_express( cur_router, dest_router );
+      out_port = dor_no_express_cmesh_port( cur_router, f->dest );
     }
   }
 
@@ -854,3 +883,13 @@ void dor_no_express_cmesh( const Router *r, const Flit *f, int in_channel,
 
   outputs->AddRange( out_port, vcBegin, vcEnd );
 }
+
+void CMesh::BuildRoutingTable( const string & routing_function, int max_entries )
+{
+  gCMeshTable.Clear();
+  if ( routing_function == "dor" ) {
+    gCMeshTable.Build( powi( gK, gN ), gNodes, max_entries, &dor_cmesh_port );
+  } else if ( routing_function == "dor_no_express" ) {
+    gCMeshTable.Build( powi( gK, gN ), gNodes, max_entries, &dor_no_express_cmesh_port );
+  }
+}
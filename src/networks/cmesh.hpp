@@ -54,6 +54,8 @@ public:
   static int NodeToPort( int address ) ;
 
   static void RegisterRoutingFunctions() ;
+  // dense next-hop table for the dor routing functions, if it fits
+  static void BuildRoutingTable( const string & routing_function, int max_entries ) ;
 
 private:
 
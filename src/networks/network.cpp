@@ -33,7 +33,9 @@
  */
 
 #include <cassert>
+#include <cmath>
 #include <sstream>
+#include <algorithm>
 
 #include "../booksim.hpp"
 #include "network.hpp"
@@ -57,6 +59,13 @@ Network::Network( const Configuration &config, const string & name ) :
   _nodes    = -1; 
   _channels = -1;
   _classes  = config.GetInt("classes");
+
+  // a router skipped while idle would miss its fractional internal cycles
+  double const speedup = config.GetFloat("internal_speedup");
+  _schedule_active = (floor(speedup) == speedup);
+  _scheduler_ready = false;
+  _pool = NULL;
+  _parallel_count = 0;
 }
 
 Network::~Network( )
@@ -137,6 +146,7 @@ void Network::_Alloc( )
   _routers.resize(_size);
   _hubs.resize(_nhubs);
   gNodes = _nodes;
+  NodeSet::SetNodes(_nodes);
 
   /*booksim used arrays of flits as the channels which makes have capacity of
    *one. To simulate channel latency, flitchannel class has been added
@@ -151,11 +161,11 @@ void Network::_Alloc( )
     name << Name() << "_fchan_ingress" << s;
     _inject[s] = new FlitChannel(this, name.str(), _classes);
     _inject[s]->SetSource(NULL, s);
-    _timed_modules.push_back(_inject[s]);
+    _inject[s]->SetTimingWheel(&_wheel);
     name.str("");
     name << Name() << "_cchan_ingress" << s;
     _inject_cred[s] = new CreditChannel(this, name.str());
-    _timed_modules.push_back(_inject_cred[s]);
+    _inject_cred[s]->SetTimingWheel(&_wheel);
   }
   _eject.resize(_nodes);
   _eject_cred.resize(_nodes);
@@ -164,11 +174,11 @@ void Network::_Alloc( )
     name << Name() << "_fchan_egress" << d;
     _eject[d] = new FlitChannel(this, name.str(), _classes);
     _eject[d]->SetSink(NULL, d);
-    _timed_modules.push_back(_eject[d]);
+    _eject[d]->SetTimingWheel(&_wheel);
     name.str("");
     name << Name() << "_cchan_egress" << d;
     _eject_cred[d] = new CreditChannel(this, name.str());
-    _timed_modules.push_back(_eject_cred[d]);
+    _eject_cred[d]->SetTimingWheel(&_wheel);
   }
   //Bransan Increased size of chan and chan_cred to accomodate hub
   _chan.resize(_channels);
@@ -177,11 +187,11 @@ void Network::_Alloc( )
     ostringstream name;
     name << Name() << "_fchan_" << c;
     _chan[c] = new FlitChannel(this, name.str(), _classes);
-    _timed_modules.push_back(_chan[c]);
+    _chan[c]->SetTimingWheel(&_wheel);
     name.str("");
     name << Name() << "_cchan_" << c;
     _chan_cred[c] = new CreditChannel(this, name.str());
-    _timed_modules.push_back(_chan_cred[c]);
+    _chan_cred[c]->SetTimingWheel(&_wheel);
   }
 
   // _chan_cred.resize(_channels);
@@ -190,13 +200,162 @@ void Network::_Alloc( )
     ostringstream name;
     name << Name() << "_pay_chan_" << c;
     _payload_chan[c] = new PayloadChannel(this, name.str(), _classes);
-    _timed_modules.push_back(_payload_chan[c]);
+    _payload_chan[c]->SetTimingWheel(&_wheel);
+  }
+
+}
+
+static bool _EarlierModule( TimedModule const * a, TimedModule const * b )
+{
+  return a->GetOrder( ) < b->GetOrder( );
+}
+
+// channel latencies are only known once the derived constructor has run
+// _BuildNet, so the wheel is sized on the first cycle
+void Network::_InitTimingWheel( )
+{
+  int horizon = 1;
+  for ( int s = 0; s < _nodes; ++s ) {
+    horizon = max(horizon, _inject[s]->GetLatency( ));
+    horizon = max(horizon, _inject_cred[s]->GetLatency( ));
+    horizon = max(horizon, _eject[s]->GetLatency( ));
+    horizon = max(horizon, _eject_cred[s]->GetLatency( ));
+  }
+  for ( int c = 0; c < _channels; ++c ) {
+    horizon = max(horizon, _chan[c]->GetLatency( ));
+    horizon = max(horizon, _chan_cred[c]->GetLatency( ));
+  }
+  for ( int c = 0; c < _p_channels; ++c ) {
+    horizon = max(horizon, _payload_chan[c]->GetLatency( ));
   }
+  _wheel.Resize(horizon, _pool ? _pool->NumThreads( ) : 1);
+}
 
+// the topology is only complete once the derived constructor has run
+// _BuildNet, so the scheduler is set up lazily on the first cycle; every
+// module starts out active
+void Network::_InitScheduler( )
+{
+  _woken_modules.resize(_pool ? _pool->NumThreads( ) : 1);
+  for(size_t i = 0; i < _timed_modules.size( ); ++i) {
+    _timed_modules[i]->SetScheduler(&_woken_modules, i);
+    _timed_modules[i]->Wake( );
+  }
+  if(_pool) {
+    _AssignRegions( );
+  }
+  _scheduler_ready = true;
+  _UpdateActiveSet( );
+}
+
+// Regions are contiguous ranges of router ids, i.e. bands of rows on a
+// mesh. A worker thus keeps stepping the same routers across phases and
+// cycles, and only crosses into a neighbouring region's state when it
+// steals.
+void Network::_AssignRegions( )
+{
+  _region.assign(_timed_modules.size( ), 0);
+  _region_modules.resize(_pool->NumThreads( ));
+  for ( int r = 0; r < _size; ++r ) {
+    _SetRegion(_routers[r], _routers[r]);
+  }
+}
+
+void Network::_SetRegion( TimedModule const * m, Router const * r )
+{
+  if(!m || !r || (m->GetOrder( ) < 0)) {
+    return;
+  }
+  int const threads = _pool->NumThreads( );
+  _region[m->GetOrder( )] = min(threads - 1, (r->GetID( ) * threads) / _size);
+}
+
+// drop modules that went idle this cycle and add the ones woken by a
+// channel delivery; the set is kept in _timed_modules order so that
+// results match stepping every module
+void Network::_UpdateActiveSet( )
+{
+  size_t kept = 0;
+  for(size_t i = 0; i < _active_modules.size( ); ++i) {
+    TimedModule * const m = _active_modules[i];
+    if(m->ClearWoken( ) || m->IsActive( )) {
+      _active_modules[kept++] = m;
+    }
+  }
+  _active_modules.resize(kept);
+  for(size_t w = 0; w < _woken_modules.size( ); ++w) {
+    for(vector<TimedModule *>::const_iterator iter = _woken_modules[w].begin();
+	iter != _woken_modules[w].end();
+	++iter) {
+      if((*iter)->ClearWoken( )) {
+	_active_modules.push_back(*iter);
+      }
+    }
+    _woken_modules[w].clear( );
+  }
+  sort(_active_modules.begin( ) + kept, _active_modules.end( ), _EarlierModule);
+  inplace_merge(_active_modules.begin( ), _active_modules.begin( ) + kept,
+		_active_modules.end( ), _EarlierModule);
+
+  if(_pool) {
+    for(size_t w = 0; w < _region_modules.size( ); ++w) {
+      _region_modules[w].clear( );
+    }
+    _serial_modules.clear( );
+    for(vector<TimedModule *>::const_iterator iter = _active_modules.begin();
+	iter != _active_modules.end();
+	++iter) {
+      if((*iter)->IsThreadSafe( )) {
+	_region_modules[_region[(*iter)->GetOrder( )]].push_back(*iter);
+      } else {
+	_serial_modules.push_back(*iter);
+      }
+    }
+    _parallel_count = _active_modules.size( ) - _serial_modules.size( );
+  }
+}
+
+// Thread-safe modules of one phase are independent of each other, so the
+// pool may step them in any order. Anything they share (flit and packet ids
+// handed out by IQRouter) is settled by Commit in module order before the
+// remaining modules run; those are hubs, which always follow the routers in
+// _timed_modules, so the serial order of side effects is preserved.
+//
+// Evaluate only reads a module's own state and WriteOutputs only schedules
+// channel deliveries, so the parallel part runs both in a single pass and
+// saves one barrier per cycle. This relies on WriteOutputs being
+// called right after Evaluate, as TrafficManager::_Step does.
+void Network::_StepActive( ThreadPool::Phase phase )
+{
+  if(_pool && (_parallel_count >= 2 * _pool->NumThreads( ))) {
+    if(phase == ThreadPool::READ_INPUTS) {
+      _pool->Run(_region_modules, phase);
+    } else if(phase == ThreadPool::EVALUATE) {
+      _pool->Run(_region_modules, ThreadPool::EVALUATE_WRITE);
+      for(vector<TimedModule *>::const_iterator iter = _active_modules.begin();
+	  iter != _active_modules.end();
+	  ++iter) {
+	(*iter)->Commit( );
+      }
+    }
+    ThreadPool::Step(_serial_modules, 0, _serial_modules.size( ), phase);
+    return;
+  }
+  ThreadPool::Step(_active_modules, 0, _active_modules.size( ), phase);
 }
 
 void Network::ReadInputs( )
 {
+  if(!_wheel.IsReady( )) {
+    _InitTimingWheel( );
+  }
+  if(_schedule_active) {
+    if(!_scheduler_ready) {
+      _InitScheduler( );
+    }
+    _StepActive(ThreadPool::READ_INPUTS);
+    return;
+  }
   for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
       iter != _timed_modules.end();
       ++iter) {
@@ -206,6 +365,10 @@ void Network::ReadInputs( )
 
 void Network::Evaluate( )
 {
+  if(_scheduler_ready) {
+    _StepActive(ThreadPool::EVALUATE);
+    return;
+  }
   for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
       iter != _timed_modules.end();
       ++iter) {
@@ -215,11 +378,51 @@ void Network::Evaluate( )
 
 void Network::WriteOutputs( )
 {
+  if(_scheduler_ready) {
+    _StepActive(ThreadPool::WRITE_OUTPUTS);
+    _wheel.Advance(GetSimTime( ));
+    _UpdateActiveSet( );
+    return;
+  }
   for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
       iter != _timed_modules.end();
       ++iter) {
     (*iter)->WriteOutputs( );
   }
+  _wheel.Advance(GetSimTime( ));
+}
+
+// true when no router or channel has pending work, i.e. stepping the
+// network would not change any state
+bool Network::IsQuiescent( ) const
+{
+  if(!_wheel.IsIdle( )) {
+    return false;
+  }
+  if(_scheduler_ready) {
+    // modules outside the active set are idle unless they were woken
+    for(size_t w = 0; w < _woken_modules.size( ); ++w) {
+      if(!_woken_modules[w].empty( )) {
+	return false;
+      }
+    }
+    for(vector<TimedModule *>::const_iterator iter = _active_modules.begin();
+	iter != _active_modules.end();
+	++iter) {
+      if((*iter)->IsActive( )) {
+	return false;
+      }
+    }
+    return true;
+  }
+  for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
+      iter != _timed_modules.end();
+      ++iter) {
+    if((*iter)->IsActive( )) {
+      return false;
+    }
+  }
+  return true;
 }
 
 void Network::WriteFlit( Flit *f, int source )
@@ -43,6 +43,7 @@
 #include "../globals.hpp"
 #include "../routers/hub.hpp"
 #include "../payloadchannel.hpp"
+#include "../thread_pool.hpp"
 
 typedef Channel<Credit> CreditChannel;
 
@@ -76,7 +77,31 @@ protected:
 
   vector<PayloadChannel *> _payload_chan;  //Bransan added
 
+  // routers and hubs; channels are driven by _wheel instead
   deque<TimedModule *> _timed_modules;
+  TimingWheel _wheel;
+
+  // active-set scheduling: only modules with pending work, or that were
+  // woken by a neighbour, are stepped each cycle
+  bool _schedule_active;
+  bool _scheduler_ready;
+  vector<TimedModule *> _active_modules;
+  vector<vector<TimedModule *> > _woken_modules; // one list per worker
+
+  // with sim_threads > 1 the thread-safe part of the active set is stepped
+  // by the pool, one region per worker, the rest serially afterwards
+  ThreadPool * _pool;
+  vector<int> _region; // by module order
+  vector<vector<TimedModule *> > _region_modules;
+  int _parallel_count;
+  vector<TimedModule *> _serial_modules;
+
+  void _InitTimingWheel( );
+  void _InitScheduler( );
+  void _AssignRegions( );
+  void _SetRegion( TimedModule const * m, Router const * r );
+  void _UpdateActiveSet( );
+  void _StepActive( ThreadPool::Phase phase );
 
   virtual void _ComputeSize( const Configuration &config ) = 0;
   virtual void _BuildNet( const Configuration &config ) = 0;
@@ -108,6 +133,10 @@ public:
   virtual void Evaluate( );
   virtual void WriteOutputs( );
 
+  bool IsQuiescent( ) const;
+
+  void SetThreadPool( ThreadPool * pool ) { _pool = pool; }
+
   void Display( ostream & os = cout ) const;
   void DumpChannelMap( ostream & os = cout, string const & prefix = "" ) const;
   void DumpNodeMap( ostream & os = cout, string const & prefix = "" ) const;
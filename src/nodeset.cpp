@@ -0,0 +1,141 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*nodeset.cpp
+ *
+ *bit vector of node ids, see nodeset.hpp
+ */
+
+#include <algorithm>
+
+#include "booksim.hpp"
+#include "nodeset.hpp"
+
+int NodeSet::_nodes = 0;
+int NodeSet::_words = 0;
+
+void NodeSet::SetNodes( int nodes )
+{
+  assert( nodes >= 0 );
+  _nodes = nodes;
+  _words = ( nodes + WORD_BITS - 1 ) / WORD_BITS;
+}
+
+void NodeSet::Clear( )
+{
+  for ( size_t w = 0; w < _bits.size( ); ++w ) {
+    _bits[w] = 0;
+  }
+}
+
+void NodeSet::Insert( int node )
+{
+  assert( ( node >= 0 ) && ( node < _nodes ) );
+  if ( _bits.empty( ) ) {
+    _bits.resize( _words, 0 );
+  }
+  _bits[node / WORD_BITS] |= tWord(1) << ( node % WORD_BITS );
+}
+
+void NodeSet::Erase( int node )
+{
+  assert( ( node >= 0 ) && ( node < _nodes ) );
+  if ( !_bits.empty( ) ) {
+    _bits[node / WORD_BITS] &= ~( tWord(1) << ( node % WORD_BITS ) );
+  }
+}
+
+bool NodeSet::Contains( int node ) const
+{
+  if ( ( node < 0 ) || ( node / WORD_BITS >= (int)_bits.size( ) ) ) {
+    return false;
+  }
+  return ( _bits[node / WORD_BITS] >> ( node % WORD_BITS ) ) & 1;
+}
+
+bool NodeSet::Empty( ) const
+{
+  for ( size_t w = 0; w < _bits.size( ); ++w ) {
+    if ( _bits[w] ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int NodeSet::Size( ) const
+{
+  int size = 0;
+  for ( size_t w = 0; w < _bits.size( ); ++w ) {
+    size += __builtin_popcountll( _bits[w] );
+  }
+  return size;
+}
+
+int NodeSet::Next( int node ) const
+{
+  ++node;
+  size_t w = node / WORD_BITS;
+  if ( w >= _bits.size( ) ) {
+    return -1;
+  }
+  tWord bits = _bits[w] & ( ~tWord(0) << ( node % WORD_BITS ) );
+  while ( !bits ) {
+    if ( ++w >= _bits.size( ) ) {
+      return -1;
+    }
+    bits = _bits[w];
+  }
+  return w * WORD_BITS + __builtin_ctzll( bits );
+}
+
+void NodeSet::Intersect( const NodeSet & a, const NodeSet & b )
+{
+  size_t const words = min( a._bits.size( ), b._bits.size( ) );
+  if ( words == 0 ) {
+    Clear( );
+    return;
+  }
+  _bits.resize( _words, 0 );
+  for ( size_t w = 0; w < words; ++w ) {
+    _bits[w] = a._bits[w] & b._bits[w];
+  }
+  for ( size_t w = words; w < _bits.size( ); ++w ) {
+    _bits[w] = 0;
+  }
+}
+
+NodeSet & NodeSet::operator|=( const NodeSet & s )
+{
+  if ( _bits.size( ) < s._bits.size( ) ) {
+    _bits.resize( s._bits.size( ), 0 );
+  }
+  for ( size_t w = 0; w < s._bits.size( ); ++w ) {
+    _bits[w] |= s._bits[w];
+  }
+  return *this;
+}
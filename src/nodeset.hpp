@@ -0,0 +1,82 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*nodeset.hpp
+ *
+ *Set of network nodes stored as a bit vector, one bit per node. The
+ *width is fixed once the network knows how many nodes it has, so
+ *multicast destination lists can be split across output ports with a
+ *few word-wide ANDs instead of per-destination lookups.
+ *
+ *A set only allocates its words when it first becomes non-empty.
+ */
+
+#ifndef _NODESET_HPP_
+#define _NODESET_HPP_
+
+#include <vector>
+#include <cassert>
+
+using namespace std;
+
+class NodeSet {
+
+public:
+  NodeSet( ) {}
+
+  // set once by the network before any set is filled
+  static void SetNodes( int nodes );
+  static int Nodes( ) { return _nodes; }
+
+  void Clear( );
+  void Insert( int node );
+  void Erase( int node );
+  bool Contains( int node ) const;
+
+  bool Empty( ) const;
+  int  Size( ) const;
+
+  // lowest node in the set / next node after 'node', -1 if there is none
+  int First( ) const { return Next( -1 ); }
+  int Next( int node ) const;
+
+  // this = a & b
+  void Intersect( const NodeSet & a, const NodeSet & b );
+
+  NodeSet & operator|=( const NodeSet & s );
+
+private:
+  typedef unsigned long long tWord;
+  static const int WORD_BITS = 64;
+
+  static int _nodes;
+  static int _words;
+
+  vector<tWord> _bits;
+};
+
+#endif
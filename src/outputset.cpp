@@ -34,13 +34,33 @@
  */
 
 #include <cassert>
+#include <algorithm>
 
 #include "booksim.hpp"
 #include "outputset.hpp"
 
+OutputSet::OutputSet( const OutputSet & s )
+  : _size(0)
+{
+  *this = s;
+}
+
+OutputSet & OutputSet::operator=( const OutputSet & s )
+{
+  if ( this != &s ) {
+    _size = s._size;
+    _overflow = s._overflow;
+    if ( _overflow.empty( ) ) {
+      copy( s._inline, s._inline + _size, _inline );
+    }
+  }
+  return *this;
+}
+
 void OutputSet::Clear( )
 {
-  _outputs.clear( );
+  _size = 0;
+  _overflow.clear( );
 }
 
 void OutputSet::Add( int output_port, int vc, int pri  )
@@ -57,41 +77,51 @@ void OutputSet::AddRange( int output_port, int vc_start, int vc_end, int pri )
   s.vc_end   = vc_end;
   s.pri      = pri;
   s.output_port = output_port;
-  // s.rid 
-  _outputs.insert( s );
+
+  sSetElement * data = _Data( );
+  int pos = 0;
+  while ( ( pos < _size ) && ( data[pos].pri > pri ) ) {
+    ++pos;
+  }
+  if ( ( pos < _size ) && ( data[pos].pri == pri ) ) {
+    // same priority as an existing entry: keep the existing one
+    return;
+  }
+
+  if ( _overflow.empty( ) && ( _size < INLINE_SIZE ) ) {
+    copy_backward( _inline + pos, _inline + _size, _inline + _size + 1 );
+    _inline[pos] = s;
+  } else {
+    if ( _overflow.empty( ) ) {
+      _overflow.assign( _inline, _inline + _size );
+    }
+    _overflow.insert( _overflow.begin( ) + pos, s );
+  }
+  ++_size;
 }
 
 //legacy support, for performance, just use GetSet()
 int OutputSet::NumVCs( int output_port ) const
 {
   int total = 0;
-  set<sSetElement>::const_iterator i = _outputs.begin( );
-  while(i!=_outputs.end( )){
+  for ( const_iterator i = begin( ); i != end( ); ++i ) {
     if(i->output_port == output_port){
       total += (i->vc_end - i->vc_start + 1);
     }
-    i++;
   }
   return total;
 }
 
 bool OutputSet::OutputEmpty( int output_port ) const
 {
-  set<sSetElement>::const_iterator i = _outputs.begin( );
-  while(i!=_outputs.end( )){
+  for ( const_iterator i = begin( ); i != end( ); ++i ) {
     if(i->output_port == output_port){
       return false;
     }
-    i++;
   }
   return true;
 }
 
-
-const set<OutputSet::sSetElement> & OutputSet::GetSet() const{
-  return _outputs;
-}
-
 //legacy support, for performance, just use GetSet()
 int OutputSet::GetVC( int output_port, int vc_index, int *pri ) const
 {
@@ -102,8 +132,7 @@ int OutputSet::GetVC( int output_port, int vc_index, int *pri ) const
   
   if ( pri ) { *pri = -1; }
 
-  set<sSetElement>::const_iterator i = _outputs.begin( );
-  while(i!=_outputs.end( )){
+  for ( const_iterator i = begin( ); i != end( ); ++i ) {
     if(i->output_port == output_port){
       range = i->vc_end - i->vc_start + 1;
       if ( remaining >= range ) {
@@ -116,7 +145,6 @@ int OutputSet::GetVC( int output_port, int vc_index, int *pri ) const
 	break;
       }
     }
-    i++;
   }
   return vc;
 }
@@ -129,11 +157,11 @@ bool OutputSet::GetPortVC( int *out_port, int *out_vc ) const
   bool single_output = false;
   int  used_outputs  = 0;
 
-  set<sSetElement>::const_iterator i = _outputs.begin( );
-  if(i!=_outputs.end( )){
+  const_iterator i = begin( );
+  if(i!=end( )){
     used_outputs = i->output_port;
   }
-  while(i!=_outputs.end( )){
+  while(i!=end( )){
 
     if ( i->vc_start == i->vc_end ) {
       *out_vc   = i->vc_start;
@@ -28,8 +28,14 @@
 #ifndef _OUTPUTSET_HPP_
 #define _OUTPUTSET_HPP_
 
-#include <set>
+#include <vector>
 
+using namespace std;
+
+// Entries are kept sorted by priority, highest first, and at most one entry
+// is kept per priority level (a later range with an already used priority
+// is ignored). The first INLINE_SIZE entries are stored in the object
+// itself, so routing a flit does not touch the heap.
 class OutputSet {
 
 
@@ -41,6 +47,12 @@ public:
     int output_port;
   };
 
+  typedef const sSetElement * const_iterator;
+
+  OutputSet( ) : _size(0) {}
+  OutputSet( const OutputSet & s );
+  OutputSet & operator=( const OutputSet & s );
+
   void Clear( );
   void Add( int output_port, int vc, int pri = 0 );
   void AddRange( int output_port, int vc_start, int vc_end, int pri = 0 );
@@ -48,19 +60,25 @@ public:
   bool OutputEmpty( int output_port ) const;
   int NumVCs( int output_port ) const;
   
-  const set<sSetElement> & GetSet() const;
+  const OutputSet & GetSet() const { return *this; }
+
+  const_iterator begin( ) const { return _Data( ); }
+  const_iterator end( ) const { return _Data( ) + _size; }
+  int size( ) const { return _size; }
+  bool empty( ) const { return _size == 0; }
 
   int  GetVC( int output_port,  int vc_index, int *pri = 0 ) const;
   bool GetPortVC( int *out_port, int *out_vc ) const;
 private:
-  set<sSetElement> _outputs;
-};
+  static const int INLINE_SIZE = 4;
 
-inline bool operator<(const OutputSet::sSetElement & se1, 
-	       const OutputSet::sSetElement & se2) {
-  return se1.pri > se2.pri; // higher priorities first!
-}
-
-#endif
+  int _size;
+  sSetElement _inline[INLINE_SIZE];
+  // only used once more than INLINE_SIZE priority levels are present
+  vector<sSetElement> _overflow;
 
+  sSetElement * _Data( ) { return _overflow.empty( ) ? _inline : &_overflow[0]; }
+  const sSetElement * _Data( ) const { return _overflow.empty( ) ? _inline : &_overflow[0]; }
+};
 
+#endif
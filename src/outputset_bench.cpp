@@ -0,0 +1,116 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*outputset_bench.cpp
+ *
+ *Microbenchmark for the routing stage's use of OutputSet: clear the set,
+ *let a routing function add its ranges, then walk the result the way
+ *IQRouter's VC allocation does. The previous std::set based container is
+ *kept here as the baseline.
+ *
+ *Build with "make bench" and run ./outputset_bench [iterations]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <set>
+
+#include "outputset.hpp"
+
+// the std::set based OutputSet this tree used before
+class SetOutputSet {
+public:
+  void Clear( ) { _outputs.clear( ); }
+  void AddRange( int output_port, int vc_start, int vc_end, int pri = 0 )
+  {
+    OutputSet::sSetElement s;
+    s.vc_start = vc_start;
+    s.vc_end   = vc_end;
+    s.pri      = pri;
+    s.output_port = output_port;
+    _outputs.insert( s );
+  }
+  struct PriGreater {
+    bool operator()( const OutputSet::sSetElement & a,
+		     const OutputSet::sSetElement & b ) const
+    {
+      return a.pri > b.pri;
+    }
+  };
+  const set<OutputSet::sSetElement, PriGreater> & GetSet( ) const { return _outputs; }
+private:
+  set<OutputSet::sSetElement, PriGreater> _outputs;
+};
+
+// dimension-order style: one range per hop; adaptive style: a few
+// candidate ports at different priorities
+template<class T>
+static long Route( T & outputs, int iterations, int ranges )
+{
+  long sum = 0;
+  for ( int i = 0; i < iterations; ++i ) {
+    outputs.Clear( );
+    for ( int r = 0; r < ranges; ++r ) {
+      outputs.AddRange( ( i + r ) % 5, 0, 7, ranges - r );
+    }
+    for ( auto iset = outputs.GetSet( ).begin( );
+	  iset != outputs.GetSet( ).end( ); ++iset ) {
+      sum += iset->output_port + iset->vc_end - iset->vc_start;
+    }
+  }
+  return sum;
+}
+
+template<class T>
+static double TimeRoute( int iterations, int ranges, long & check )
+{
+  T outputs;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now( );
+  check = Route( outputs, iterations, ranges );
+  chrono::steady_clock::time_point stop = chrono::steady_clock::now( );
+  return chrono::duration<double, nano>( stop - start ).count( ) / iterations;
+}
+
+int main( int argc, char ** argv )
+{
+  int iterations = ( argc > 1 ) ? atoi( argv[1] ) : 10000000;
+
+  int const ranges[] = { 1, 2, 3 };
+  for ( int r = 0; r < 3; ++r ) {
+    long before_check, after_check;
+    double before = TimeRoute<SetOutputSet>( iterations, ranges[r], before_check );
+    double after = TimeRoute<OutputSet>( iterations, ranges[r], after_check );
+    if ( before_check != after_check ) {
+      cerr << "Mismatch between std::set and inline OutputSet results." << endl;
+      return 1;
+    }
+    cout << ranges[r] << " range(s) per route: std::set " << before
+	 << " ns, inline " << after << " ns per routing decision" << endl;
+  }
+  return 0;
+}
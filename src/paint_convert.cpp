@@ -0,0 +1,57 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*paint_convert.cpp
+ *
+ *Rebuilds the _paint.json timeline from the _paint.jsonl stream of a
+ *run, including runs that were killed before writing it themselves.
+ *
+ *Build with "make booksim-paint-convert" and run
+ *./booksim-paint-convert IR_paint.jsonl IR_paint.json
+ */
+
+#include <iostream>
+#include <string>
+
+#include "paint_writer.hpp"
+
+using namespace std;
+
+int main( int argc, char ** argv )
+{
+  if ( argc != 3 ) {
+    cerr << "usage: " << argv[0] << " <paint.jsonl> <paint.json>" << endl;
+    return 1;
+  }
+
+  string error;
+  if ( !PaintWriter::Convert( argv[1], argv[2], error ) ) {
+    cerr << error << endl;
+    return 1;
+  }
+  return 0;
+}
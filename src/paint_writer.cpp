@@ -0,0 +1,190 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*paint_writer.cpp
+ *
+ *Background writer for the workload timeline and its conversion back to
+ *the _paint.json document.
+ */
+
+#include "booksim.hpp"
+#include "paint_writer.hpp"
+#include "json.hpp"
+
+PaintWriter::PaintWriter( ) : _closing( false )
+{
+}
+
+PaintWriter::~PaintWriter( )
+{
+  if ( IsOpen( ) ) {
+    Close( -1, 0, vector<int>( ) );
+  }
+}
+
+bool PaintWriter::Open( const string & file )
+{
+  assert( !IsOpen( ) );
+  _out.open( file.c_str( ), ios::trunc );
+  if ( !_out ) {
+    return false;
+  }
+  _closing = false;
+  _batch.reserve( BATCH );
+  _thread = thread( &PaintWriter::_Loop, this );
+  return true;
+}
+
+void PaintWriter::Workload( int core, int order, int start, int end,
+			    const string * layer, int batch )
+{
+  if ( !IsOpen( ) ) {
+    return;
+  }
+  Record const r = { core, order, start, end, batch, layer };
+  _batch.push_back( r );
+  if ( _batch.size( ) >= BATCH ) {
+    Flush( );
+  }
+}
+
+void PaintWriter::Flush( )
+{
+  if ( _batch.empty( ) || !IsOpen( ) ) {
+    return;
+  }
+  unique_lock<mutex> lock( _lock );
+  _space.wait( lock, [this] { return _pending.size( ) < MAX_PENDING; } );
+  _pending.push_back( vector<Record>( ) );
+  _pending.back( ).swap( _batch );
+  lock.unlock( );
+  _ready.notify_one( );
+  _batch.reserve( BATCH );
+}
+
+void PaintWriter::Close( int end, int core_num, const vector<int> & cores )
+{
+  if ( !IsOpen( ) ) {
+    return;
+  }
+  Flush( );
+  {
+    lock_guard<mutex> lock( _lock );
+    _closing = true;
+  }
+  _ready.notify_one( );
+  _thread.join( );
+
+  if ( end >= 0 ) {
+    nlohmann::json last;
+    last["end"] = end;
+    last["core_num"] = core_num;
+    last["cores"] = cores;
+    _out << last << '\n';
+  }
+  _out.close( );
+}
+
+void PaintWriter::_Loop( )
+{
+  unique_lock<mutex> lock( _lock );
+  for ( ;; ) {
+    _ready.wait( lock, [this] { return !_pending.empty( ) || _closing; } );
+    if ( _pending.empty( ) ) {
+      return;
+    }
+    vector<Record> records;
+    records.swap( _pending.front( ) );
+    lock.unlock( );
+    _Write( records );
+    lock.lock( );
+    _pending.pop_front( );
+    _space.notify_one( );
+  }
+}
+
+void PaintWriter::_Write( const vector<Record> & records )
+{
+  for ( size_t i = 0; i < records.size( ); ++i ) {
+    const Record & r = records[i];
+    _out << "{\"core\":" << r.core << ",\"workload\":" << r.order
+	 << ",\"start\":" << r.start << ",\"end\":" << r.end
+	 << ",\"layer\":" << nlohmann::json( *r.layer ).dump( )
+	 << ",\"batch\":" << r.batch << "}\n";
+  }
+  // lines reach the file batch by batch, so a killed run loses at most
+  // the records not handed off yet
+  _out.flush( );
+}
+
+bool PaintWriter::Convert( const string & file, const string & paint, string & error )
+{
+  ifstream in( file.c_str( ) );
+  if ( !in ) {
+    error = "cannot open " + file;
+    return false;
+  }
+  nlohmann::json j;
+  string line;
+  int line_num = 0;
+  while ( getline( in, line ) ) {
+    ++line_num;
+    if ( line.empty( ) ) {
+      continue;
+    }
+    nlohmann::json const r = nlohmann::json::parse( line, nullptr, false );
+    if ( r.is_discarded( ) || !r.is_object( ) ) {
+      // the last line of a killed run may be cut short
+      if ( in.peek( ) == EOF ) {
+	break;
+      }
+      error = file + ":" + to_string( line_num ) + ": malformed record";
+      return false;
+    }
+    if ( r.count( "workload" ) ) {
+      nlohmann::json & w = j[to_string( r["core"].get<int>( ) )][to_string( r["workload"].get<int>( ) )];
+      w["start"] = r["start"];
+      w["layer"] = r["layer"];
+      w["batch"] = r["batch"];
+      w["end"] = r["end"];
+    } else {
+      // cores that ran no workload still get an (empty) entry
+      for ( auto & c : r["cores"] ) {
+	j[to_string( c.get<int>( ) )];
+      }
+      j["attribute"]["end"] = r["end"];
+      j["attribute"]["core_num"] = r["core_num"];
+    }
+  }
+
+  ofstream out( paint.c_str( ) );
+  if ( !( out << j ) ) {
+    error = "cannot write " + paint;
+    return false;
+  }
+  return true;
+}
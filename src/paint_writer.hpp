@@ -0,0 +1,105 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*paint_writer.hpp
+ *
+ *Streams the workload timeline of a run to an append-only file, one JSON
+ *object per line, as workloads finish. The simulation thread only appends
+ *fixed-size records to a batch; full batches are formatted and written by
+ *a background thread, so memory stays bounded by a few batches and a run
+ *that gets killed leaves every batch handed off so far on disk.
+ *
+ *A stream looks like
+ *  {"core":1,"workload":0,"start":413,"end":5413,"layer":"conv1","batch":2}
+ *  ...
+ *  {"end":10800,"core_num":16,"cores":[1,2,...]}
+ *where the last line is only written by Close. Convert rebuilds the
+ *_paint.json document from a complete or partial stream.
+ */
+
+#ifndef _PAINT_WRITER_HPP_
+#define _PAINT_WRITER_HPP_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+class PaintWriter {
+
+public:
+  PaintWriter( );
+  ~PaintWriter( );
+
+  bool Open( const string & file );
+  bool IsOpen( ) const { return _thread.joinable( ); }
+
+  // one finished workload; layer must stay valid until Close
+  void Workload( int core, int order, int start, int end,
+		 const string * layer, int batch );
+  // hands the records gathered so far to the writer thread
+  void Flush( );
+  // writes the closing record and waits for everything to be on disk
+  void Close( int end, int core_num, const vector<int> & cores );
+
+  // writes the _paint.json document for the stream in file
+  static bool Convert( const string & file, const string & paint, string & error );
+
+private:
+  struct Record {
+    int core;
+    int order;
+    int start;
+    int end;
+    int batch;
+    const string * layer;
+  };
+
+  // records per batch and batches waiting for the writer thread
+  static const size_t BATCH = 4096;
+  static const size_t MAX_PENDING = 4;
+
+  ofstream _out;
+  vector<Record> _batch;
+
+  thread _thread;
+  mutex _lock;
+  condition_variable _ready;	// a batch was queued or the writer is closing
+  condition_variable _space;	// a batch was written
+  deque<vector<Record> > _pending;
+  bool _closing;
+
+  void _Loop( );
+  void _Write( const vector<Record> & records );
+};
+
+#endif
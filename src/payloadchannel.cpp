@@ -64,26 +64,20 @@ void PayloadChannel::SetSink(Router const * const router, int port) {
 void PayloadChannel::Send(Payload * p) {
   if(p) {
     _active[p->_flits[0]->cl] += p->_flits.size();
+    if(p->watch) {
+      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
+		 << "Beginning channel traversal for payload " << p->id
+		 << " with delay " << _delay
+		 << "." << endl;
+    }
   } else {
     ++_idle;
   }
   Channel<Payload>::Send(p);
 }
 
-void PayloadChannel::ReadInputs() {
-  Payload const * const & f = _input;
-  
-  if(f && f->watch) {
-    *gWatchOut << GetSimTime() << " | " << FullName() << " | "
-	       << "Beginning channel traversal for payload " << f->id
-	       << " with delay " << _delay
-	       << "." << endl;
-  }
-  Channel<Payload>::ReadInputs();
-}
-
-void PayloadChannel::WriteOutputs() {
-  Channel<Payload>::WriteOutputs();
+void PayloadChannel::Deliver() {
+  Channel<Payload>::Deliver();
   if(_output && _output->watch) {
     *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 	       << "Completed channel traversal for payload " << _output->id
@@ -75,8 +75,7 @@ public:
   // Send Payload 
   virtual void Send(Payload * payload);
 
-  virtual void ReadInputs();
-  virtual void WriteOutputs();
+  virtual void Deliver();
 
 private:
   
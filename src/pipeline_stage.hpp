@@ -0,0 +1,141 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*pipeline_stage.hpp
+ *
+ *Per-(input,VC) state of one IQRouter pipeline stage, kept in dense
+ *arrays indexed by input * vcs + vc: the stage result (output/VC or
+ *stall code) and two intrusive FIFO lists threaded through the same
+ *slots, one for VCs waiting to be evaluated and one for the batch that
+ *was evaluated and completes at the stage's ready time.
+ *
+ *Stages only ever visit the VCs on their lists, in the order they
+ *arrived. Pending VCs are held back while an earlier batch is still in
+ *flight, which is what the deque-based stages did by stopping at the
+ *first entry that already had a time.
+ */
+
+#ifndef _PIPELINE_STAGE_HPP_
+#define _PIPELINE_STAGE_HPP_
+
+#include <vector>
+#include <cassert>
+
+using namespace std;
+
+class PipelineStage {
+
+public:
+  PipelineStage( ) : _vcs(0), _time(-1),
+    _pending_head(-1), _pending_tail(-1), _flight_head(-1) {}
+
+  void Resize( int inputs, int vcs )
+  {
+    _vcs = vcs;
+    _result.resize( inputs * vcs, -1 );
+    _next_pending.resize( inputs * vcs, -1 );
+    _next_flight.resize( inputs * vcs, -1 );
+    _is_pending.resize( inputs * vcs, false );
+  }
+
+  bool Empty( ) const { return ( _pending_head < 0 ) && ( _flight_head < 0 ); }
+
+  // queue a VC for evaluation; its result is -1 until the stage sets it
+  void Push( int input, int vc )
+  {
+    int const slot = input * _vcs + vc;
+    assert( !_is_pending[slot] );
+    _is_pending[slot] = true;
+    _next_pending[slot] = -1;
+    if ( _pending_tail < 0 ) {
+      _pending_head = slot;
+    } else {
+      _next_pending[_pending_tail] = slot;
+    }
+    _pending_tail = slot;
+  }
+
+  // VCs waiting for evaluation; none while a batch is in flight
+  int FirstPending( ) const { return ( _flight_head < 0 ) ? _pending_head : -1; }
+  int NextPending( int slot ) const { return _next_pending[slot]; }
+
+  // the pending VCs become the in-flight batch, done at time; returns
+  // the first VC of the batch, or -1 if nothing could be launched
+  int Launch( int time )
+  {
+    if ( ( _flight_head >= 0 ) || ( _pending_head < 0 ) ) {
+      return -1;
+    }
+    for ( int slot = _pending_head; slot >= 0; slot = _next_pending[slot] ) {
+      _is_pending[slot] = false;
+      _next_flight[slot] = _next_pending[slot];
+    }
+    _flight_head = _pending_head;
+    _pending_head = _pending_tail = -1;
+    _time = time;
+    return _flight_head;
+  }
+
+  // in-flight VCs, provided the batch is done by now
+  int FirstReady( int now ) const
+  {
+    return ( ( _flight_head >= 0 ) && ( _time <= now ) ) ? _flight_head : -1;
+  }
+  int NextReady( int slot ) const { return _next_flight[slot]; }
+
+  int ReadyTime( ) const { return _time; }
+
+  // retire the oldest in-flight VC and forget its result
+  void Pop( )
+  {
+    assert( _flight_head >= 0 );
+    int const slot = _flight_head;
+    _result[slot] = -1;
+    _flight_head = _next_flight[slot];
+  }
+
+  int Input( int slot ) const { return slot / _vcs; }
+  int VC( int slot ) const { return slot % _vcs; }
+
+  int & Result( int slot ) { return _result[slot]; }
+  int Result( int slot ) const { return _result[slot]; }
+
+private:
+  int _vcs;
+  int _time;
+
+  vector<int> _result;
+  vector<int> _next_pending;
+  vector<int> _next_flight;
+  vector<bool> _is_pending;
+
+  int _pending_head;
+  int _pending_tail;
+  int _flight_head;
+};
+
+#endif
@@ -30,6 +30,9 @@
 
 #include <vector>
 #include <cstdlib>
+#include <cassert>
+
+#include "thread_pool.hpp"
 
 // interface to Knuth's RANARRAY RNG
 /*
@@ -44,22 +47,29 @@ inline void RandomSeed(long seed) {
 	//  ranf_start( seed );
 }
 
+// rand() is shared state: drawing from it while routers are stepped in
+// parallel would make results depend on thread timing, so sim_threads
+// requires deterministic routing functions and allocators
 inline unsigned long RandomIntLong() {
+	assert(!ThreadPool::Parallel());
 	return rand();
 }
 
 // Returns a random integer in the range [0,max]
 inline int RandomInt(int max) {
+	assert(!ThreadPool::Parallel());
 	return (rand() % (max + 1));
 }
 
 // Returns a random floating-point value in the rage [0,1]
 inline double RandomFloat() {
+	assert(!ThreadPool::Parallel());
 	return rand() / float(RAND_MAX);
 }
 
 // Returns a random floating-point value in the rage [0,max]
 inline double RandomFloat(double max) {
+	assert(!ThreadPool::Parallel());
 	return (rand() / float(RAND_MAX) * max);
 }
 
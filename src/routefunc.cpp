@@ -50,6 +50,7 @@
 #include "networks/qtree.hpp"
 #include "networks/cmesh.hpp"
 #include "networks/wmesh.hpp"
+#include "routetable.hpp"
 #include <algorithm>
 
 
@@ -72,6 +73,27 @@ int gWriteReqBeginVC, gWriteReqEndVC;
 int gReadReplyBeginVC, gReadReplyEndVC;
 int gWriteReplyBeginVC, gWriteReplyEndVC;
 
+/* Next-hop tables, filled in by BuildRoutingTables() once the network
+ * has been built; the routing functions fall back to computing the hop
+ * when a table is not available.
+ */
+static RouteTable gMeshTable;      // dor_next_mesh, ascending order
+static RouteTable gWirelessTable;  // xy_wireless: port * 2 + wflag
+static DimOrderTable gDimTable;    // node digits for mesh and torus
+
+// Ring hop between two coordinates of a torus dimension: the direction
+// (-1 on a tie, resolved randomly) and the VC partition for each direction
+// under the fixed (det) and balanced (bal, -1 for either) datelines.
+struct TorusHop {
+  signed char dir;
+  unsigned char det[2];
+  signed char bal[2];
+};
+static vector<TorusHop> gTorusHops;
+
+// closest hub of each node, copied out of hub_mapper
+static vector<int> gHubLoc;
+
 // ============================================================
 //  QTree: Nearest Common Ancestor
 // ===
@@ -540,7 +562,7 @@ void xy_yx_mesh( const Router *r, const Flit *f,
 
 //=============================================================
 
-int dor_next_mesh( int cur, int dest, bool descending )
+static int dor_next_mesh_calc( int cur, int dest, bool descending )
 {
   if ( cur == dest ) {
     return 2*gN;  // Eject
@@ -570,6 +592,32 @@ int dor_next_mesh( int cur, int dest, bool descending )
     return 2*dim_left + 1; // Left
   }
 }
+
+static int dor_next_mesh_ascending( int cur, int dest )
+{
+  return dor_next_mesh_calc( cur, dest, false );
+}
+
+int dor_next_mesh( int cur, int dest, bool descending )
+{
+  if ( !descending && gMeshTable.Built( ) ) {
+    return gMeshTable.Lookup( cur, dest );
+  }
+  if ( !gDimTable.Built( ) ) {
+    return dor_next_mesh_calc( cur, dest, descending );
+  }
+
+  int const dim_left = descending ?
+    gDimTable.LastDiff( cur, dest ) : gDimTable.FirstDiff( cur, dest );
+  if ( dim_left < 0 ) {
+    return 2*gN;  // Eject
+  }
+  if ( gDimTable.Digit( cur, dim_left ) < gDimTable.Digit( dest, dim_left ) ) {
+    return 2*dim_left;     // Right
+  } else {
+    return 2*dim_left + 1; // Left
+  }
+}
 // Move towards nearest edge
 bool edge_direct(int cr, int cc, int dr, int dc){
   if( cc < dc){
@@ -627,13 +675,14 @@ int north_last(int cur, int dest, const Router *r){
     }
   }
 }
-int xy_wireless(int cur, int dest , int inport, int * wflag){
+static int xy_wireless_calc(int cur, int dest , int inport, int * wflag){
 
   if(cur == dest) {
+    *wflag = 0;
     return 2*gN; //Eject
   }
-  int chub = hub_mapper[cur].first;
-  int dhub = hub_mapper[dest].first;
+  int chub = gHubLoc.empty() ? hub_mapper[cur].first : gHubLoc[cur];
+  int dhub = gHubLoc.empty() ? hub_mapper[dest].first : gHubLoc[dest];
 
   int chr,chc,dhr,dhc;
   int cr,cc,dr,dc;
@@ -681,6 +730,28 @@ int xy_wireless(int cur, int dest , int inport, int * wflag){
   }
 }
 
+// table entry: the hop towards dest, or towards the closest hub if the
+// wireless path is shorter, with the wireless flag in the low bit
+static int xy_wireless_entry( int cur, int dest )
+{
+  int wflag;
+  int const port = xy_wireless_calc( cur, dest, 5, &wflag );
+  return port * 2 + wflag;
+}
+
+int xy_wireless(int cur, int dest , int inport, int * wflag){
+
+  if(!gWirelessTable.Built()) {
+    return xy_wireless_calc(cur, dest, inport, wflag);
+  }
+  int const entry = gWirelessTable.Lookup(cur, dest);
+  *wflag = entry & 1;
+  // a packet taking the wireless path leaves its hub through port 5
+  if(*wflag && inport != 5 && cur == gHubLoc[cur])
+    return 5;
+  return entry >> 1;
+}
+
 
 //=============================================================
 
@@ -692,6 +763,28 @@ void dor_next_torus( int cur, int dest, int in_port,
   int dir;
   int dist2;
 
+  if ( !gTorusHops.empty( ) ) {
+    dim_left = gDimTable.FirstDiff( cur, dest );
+    if ( dim_left < 0 ) {
+      *out_port = 2*gN;  // Eject
+    } else if ( (in_port/2) == dim_left ) {
+      *out_port = in_port ^ 0x1;
+    } else {
+      TorusHop const & hop =
+	gTorusHops[gDimTable.Digit( cur, dim_left ) * gK + gDimTable.Digit( dest, dim_left )];
+      dir = ( hop.dir >= 0 ) ? hop.dir : ( RandomInt( 1 ) ? 0 : 1 );
+      *out_port = 2*dim_left + dir;
+      if ( partition ) {
+	if ( balance ) {
+	  *partition = ( hop.bal[dir] >= 0 ) ? hop.bal[dir] : RandomInt( 1 );
+	} else {
+	  *partition = hop.det[dir];
+	}
+      }
+    }
+    return;
+  }
+
   for ( dim_left = 0; dim_left < gN; ++dim_left ) {
     if ( ( cur % gK ) != ( dest % gK ) ) { break; }
     cur /= gK; dest /= gK;
@@ -796,45 +889,53 @@ void dim_order_mesh( const Router *r, const Flit *f, int in_channel, OutputSet *
   outputs->AddRange( out_port, vcBegin, vcEnd );
 }
 */
+// per router and output port, the set of nodes dimension-order routing
+// sends through that port
+static vector<vector<NodeSet> > build_dor_mesh_port_masks()
+{
+    int const routers = powi(gK, gN);
+    vector<vector<NodeSet> > masks(routers, vector<NodeSet>(2 * gN + 1));
+    for (int rid = 0; rid < routers; ++rid) {
+        for (int dest = 0; dest < gNodes; ++dest) {
+            masks[rid][dor_next_mesh(rid, dest)].Insert(dest);
+        }
+    }
+    return masks;
+}
+
+// built on first use, once the network has set the node count
+static const vector<vector<NodeSet> > & dor_mesh_port_masks()
+{
+    static const vector<vector<NodeSet> > masks = build_dor_mesh_port_masks();
+    return masks;
+}
+
 void dim_order_mesh(const Router* r, const Flit* f, int in_channel, OutputSet* outputs, bool inject)
 {
     int out_port;
     if (f->mflag && !inject)
     {
+        const NodeSet& dests = f->GetMdest().first;
         if (f->src == r->GetID())
         {
-            vector<int> dests(f->mdest.first);
-            for (int i = 0; i < dests.size(); i++)
-            {
-                out_port = dor_next_mesh(r->GetID(), dests[i]);
-                
-                    wiredcount++;
-                
-
-                IQRouter* ir = (IQRouter*)r;
-                ir->addFlitMCastEntry(dests[i], out_port, in_channel, f->vc, false);
-
-                if (f->watch) {
-                    *gWatchOut << GetSimTime() << " | " << r->FullName() << " | "
-                        << " Outport for mdest " << dests[i]
-                        << " is " << out_port
-                        << endl;
-                }
-            }
+            wiredcount += dests.Size();
         }
-        else
+        const vector<NodeSet>& port_masks = dor_mesh_port_masks()[r->GetID()];
+        IQRouter* ir = (IQRouter*)r;
+        NodeSet port_dests;
+        for (out_port = 0; out_port < (int)port_masks.size(); ++out_port)
         {
-            vector<int> dests(f->mdest.first);
-            for (int i = 0; i < dests.size(); i++)
+            port_dests.Intersect(dests, port_masks[out_port]);
+            if (port_dests.Empty())
             {
-                out_port = dor_next_mesh(r->GetID(), dests[i]);
-                IQRouter* ir = (IQRouter*)r;
-                ir->addFlitMCastEntry(dests[i], out_port, in_channel, f->vc, false);
-                
+                continue;
+            }
+            ir->addFlitMCastEntry(port_dests, out_port, in_channel, f->vc, false);
 
-                if (f->watch) {
+            if (f->watch) {
+                for (int d = port_dests.First(); d >= 0; d = port_dests.Next(d)) {
                     *gWatchOut << GetSimTime() << " | " << r->FullName() << " | "
-                        << " Outport for mdest " << dests[i]
+                        << " Outport for mdest " << d
                         << " is " << out_port
                         << endl;
                 }
@@ -889,12 +990,16 @@ void dim_order_wmesh( const Router *r, const Flit *f, int in_channel, OutputSet
   int wflag;
   if(f->mflag && !inject)
   {
+    // the wireless decision depends on the input channel, so wired
+    // destinations are still resolved one at a time
+    const NodeSet & dests = f->GetMdest().first;
+    IQRouter* ir = (IQRouter*) r;
+    NodeSet dest_set;
     if(f->src == r->GetID())
     {
-      vector<int> dests (f->mdest.first);
-      for(int i = 0; i<dests.size(); i++)
+      for(int d = dests.First(); d >= 0; d = dests.Next(d))
       {
-        out_port = xy_wireless( r->GetID( ), dests[i] ,in_channel, &wflag);
+        out_port = xy_wireless( r->GetID( ), d ,in_channel, &wflag);
         if(wflag)
           wirelesscount++;
         else
@@ -902,12 +1007,13 @@ void dim_order_wmesh( const Router *r, const Flit *f, int in_channel, OutputSet
           wiredcount++;
         }
         
-        IQRouter* ir = (IQRouter*) r;
-        ir->addFlitMCastEntry(dests[i],out_port,in_channel,f->vc,wflag);
+        dest_set.Insert(d);
+        ir->addFlitMCastEntry(dest_set,out_port,in_channel,f->vc,wflag);
+        dest_set.Erase(d);
 
         if ( f->watch ) {
           *gWatchOut << GetSimTime() << " | " << r->FullName() << " | "
-            <<" Outport for mdest "<<dests[i]
+            <<" Outport for mdest "<<d
             <<" is "<<out_port
             <<" wireless status : "<<wflag
             <<endl; 
@@ -916,38 +1022,36 @@ void dim_order_wmesh( const Router *r, const Flit *f, int in_channel, OutputSet
     }
     else
     {
-      vector<int> dests (f->mdest.first);
-      for(int i = 0; i<dests.size(); i++)
+      for(int d = dests.First(); d >= 0; d = dests.Next(d))
       {
-        out_port = xy_wireless( r->GetID( ), dests[i] ,in_channel, &wflag);
-        IQRouter* ir = (IQRouter*) r;
-        ir->addFlitMCastEntry(dests[i],out_port,in_channel,f->vc,0);
+        out_port = xy_wireless( r->GetID( ), d ,in_channel, &wflag);
+        dest_set.Insert(d);
+        ir->addFlitMCastEntry(dest_set,out_port,in_channel,f->vc,0);
+        dest_set.Erase(d);
 
         if ( f->watch ) {
           *gWatchOut << GetSimTime() << " | " << r->FullName() << " | "
-            <<" Outport for mdest "<<dests[i]
+            <<" Outport for mdest "<<d
             <<" is "<<out_port
             <<" wireless status : 0"
             <<endl; 
         }
       }
-      if(!f->mdest.second.empty())
+      const NodeSet & wdests = f->GetMdest().second;
+      if(!wdests.Empty())
       {
-        out_port = xy_wireless( r->GetID( ), f->mdest.second[0] ,in_channel, &wflag);
-        vector<int> dests (f->mdest.second);        
-        for(int i = 0; i<dests.size(); i++)
-        {
-          IQRouter* ir = (IQRouter*) r;
-          ir->addFlitMCastEntry(dests[i],out_port,in_channel,f->vc,1);
+        out_port = xy_wireless( r->GetID( ), wdests.First() ,in_channel, &wflag);
+        ir->addFlitMCastEntry(wdests,out_port,in_channel,f->vc,1);
           
-          if ( f->watch ) {
+        if ( f->watch ) {
+          for(int d = wdests.First(); d >= 0; d = wdests.Next(d))
+          {
             *gWatchOut << GetSimTime() << " | " << r->FullName() << " | "
-              <<" Outport for mdest "<<dests[i]
+              <<" Outport for mdest "<<d
               <<" is "<<out_port
               <<" wireless status : 1"
               <<endl; 
           }
-        
         }
       }
     }
@@ -2309,3 +2413,68 @@ void InitializeRoutingMap( const Configuration & config )
   gRoutingFunctionMap["chaos_mesh"]  = &chaos_mesh;
   gRoutingFunctionMap["chaos_torus"] = &chaos_torus;
 }
+
+static void build_torus_hops( )
+{
+  gTorusHops.resize( gK * gK );
+  int const half = ( gK - 1 ) / 2;
+  for ( int cur = 0; cur < gK; ++cur ) {
+    for ( int dest = 0; dest < gK; ++dest ) {
+      TorusHop & hop = gTorusHops[cur * gK + dest];
+      int const dist2 = gK - 2 * ( ( dest - cur + gK ) % gK );
+      hop.dir = ( dist2 > 0 ) ? 0 : ( ( dist2 == 0 ) ? -1 : 1 );
+
+      // same datelines as dor_next_torus
+      hop.det[0] = ( cur > dest ) ? 1 : 0;
+      hop.det[1] = ( dest < cur ) ? 1 : 0;
+
+      if ( cur > dest ) {
+	hop.bal[0] = 1;
+      } else if ( ( cur <= half ) && ( dest > half ) ) {
+	hop.bal[0] = 0;
+      } else {
+	hop.bal[0] = -1;
+      }
+      if ( cur < dest ) {
+	hop.bal[1] = 1;
+      } else if ( ( cur > half ) && ( dest <= half ) ) {
+	hop.bal[1] = 0;
+      } else {
+	hop.bal[1] = -1;
+      }
+    }
+  }
+}
+
+void BuildRoutingTables( const Configuration & config )
+{
+  string const topo = config.GetStr( "topology" );
+  int const max_entries = config.GetInt( "route_table_size" );
+
+  gMeshTable.Clear( );
+  gWirelessTable.Clear( );
+  gDimTable.Clear( );
+  gTorusHops.clear( );
+  gHubLoc.clear( );
+
+  if ( max_entries <= 0 ) {
+    return;
+  }
+
+  if ( topo == "mesh" ) {
+    int const routers = powi( gK, gN );
+    gDimTable.Build( gK, gN, routers );
+    gMeshTable.Build( routers, gNodes, max_entries, &dor_next_mesh_ascending );
+  } else if ( topo == "torus" ) {
+    gDimTable.Build( gK, gN, powi( gK, gN ) );
+    build_torus_hops( );
+  } else if ( topo == "wmesh" ) {
+    gHubLoc.resize( gNodes );
+    for ( int node = 0; node < gNodes; ++node ) {
+      gHubLoc[node] = hub_mapper[node].first;
+    }
+    gWirelessTable.Build( gNodes, gNodes, max_entries, &xy_wireless_entry );
+  } else if ( topo == "cmesh" ) {
+    CMesh::BuildRoutingTable( config.GetStr( "routing_function" ), max_entries );
+  }
+}
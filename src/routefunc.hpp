@@ -36,6 +36,8 @@
 typedef void (*tRoutingFunction)( const Router *, const Flit *, int in_channel, OutputSet *, bool );
 
 void InitializeRoutingMap( const Configuration & config );
+// precompute next-hop tables; call once the networks have been built
+void BuildRoutingTables( const Configuration & config );
 
 extern map<string, tRoutingFunction> gRoutingFunctionMap;
 
@@ -591,7 +591,7 @@ void ChaosRouter::_OutputAdvance( )
 	}
 	
 	c = Credit::New( );
-	c->vc.insert(0);
+	c->AddVC(0);
 	_credit_queue[i].push( c );
       }
     }
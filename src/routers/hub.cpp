@@ -450,15 +450,15 @@ void Hub::_UpdateReceiveStatusMulti( )
 
 void Hub::_dest_reducto(Flit * f)
 {
-  vector <int> dests = f->mdest.second;
-  assert(f->mdest.second.size());
-  for ( vector <int>::iterator i = dests.end() - 1; i >= dests.begin() ; i--)
+  Flit::McastDest & mdest = f->MutableMdest();
+  assert(!mdest.second.Empty());
+  mdest.first.Clear();
+  for ( int d = mdest.second.First(); d >= 0; d = mdest.second.Next(d) )
   {
-    if(hub_mapper[*i].second != GetID())
-      dests.erase(i);
+    if(hub_mapper[d].second == GetID())
+      mdest.first.Insert(d);
   }
-  f->mdest.first = dests;
-  f->mdest.second.clear();
+  mdest.second.Clear();
 }
 
 void Hub::_InputQueuing()
@@ -552,7 +552,7 @@ void Hub::_InputQueuing()
         drop unnecessary flits
       */
 
-      if( (f->head && f->inter_dest != GetID() && !f->mflag) || (f->mflag && f->mdest.first.empty()) )
+      if( (f->head && f->inter_dest != GetID() && !f->mflag) || (f->mflag && f->GetMdest().first.Empty()) )
       {
         if(f->mflag)
         {
@@ -700,9 +700,8 @@ void Hub::_InputQueuing()
     BufferState *const dest_buf = _next_buf[output];
 
 #ifdef TRACK_FLOWS
-    for (set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter)
+    for (int vc = c->FirstVC(); vc >= 0; vc = c->NextVC(vc))
     {
-      int const vc = *iter;
       assert(!_outstanding_classes[output][vc].empty());
       int cl = _outstanding_classes[output][vc].front();
       _outstanding_classes[output][vc].pop();
@@ -1032,7 +1031,8 @@ vector <Flit *> Hub::_Generate_Duplicates(Flit *cf )
 
     f_list[i]->vc  = cf->vc;
     f_list[i]->mflag = cf->mflag;
-    f_list[i]->mdest = cf->mdest;
+    if(cf->mdest)
+      f_list[i]->MutableMdest() = *cf->mdest;
     
 
     if ( f_list[i]->watch ) { 
@@ -1167,12 +1167,12 @@ void Hub::_HubTraverseNew()
       {
         if(_out_queue_credits[i].first == input)
         {
-           _out_queue_credits[i].second->vc.insert(vc);
+           _out_queue_credits[i].second->AddVC(vc);
           break;
         }
       }
 
-      //_out_queue_credits.find(input)->second->vc.insert(vc);
+      //_out_queue_credits.find(input)->second->AddVC(vc);
 
     }
 
@@ -1361,7 +1361,7 @@ void Hub::_OutputQueuing()
 
     Credit *const c = iter->second;
     assert(c);
-    assert(!c->vc.empty());
+    assert(c->HasVCs());
 
     _credit_buffer[input].push(c);
   }
@@ -1442,6 +1442,17 @@ void Hub::_SendCredits()
 // misc.
 //------------------------------------------------------------------------------
 
+// only output 0 and input 0 are drained by _SendFlits/_SendCredits
+bool Hub::IsActive() const
+{
+  if (_active || !_output_buffer[0].empty() || !_credit_buffer[0].empty())
+    return true;
+  for (int output = 0; output < _outputs - 1; ++output)
+    if (!_output_buffer_wireless[output].empty())
+      return true;
+  return false;
+}
+
 void Hub::Display(ostream &os) const
 {
   for (int input = 0; input < _inputs; ++input)
@@ -1523,7 +1534,7 @@ void Hub::_UpdateNOQ(int input, int vc, Flit const *f)
   assert(f);
   assert(f->vc == vc);
   assert(f->head);
-  set<OutputSet::sSetElement> sl = f->la_route_set.GetSet();
+  OutputSet sl = f->la_route_set.GetSet();
   assert(sl.size() == 1);
   int out_port = sl.begin()->output_port;
   const FlitChannel *channel = _output_channels[out_port];
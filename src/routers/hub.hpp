@@ -194,6 +194,10 @@ class Hub : public IQRouter {
 
   virtual void ReadInputs( );
   virtual void WriteOutputs( );
+
+  virtual bool IsActive( ) const;
+  // hubs pass the wireless token through globals
+  virtual bool IsThreadSafe( ) const { return false; }
   
   void Display( ostream & os = cout ) const;
 
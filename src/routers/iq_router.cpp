@@ -36,6 +36,7 @@
 #include <cstdlib>
 #include <cassert>
 #include <limits>
+#include <algorithm>
 
 #include "../globals.hpp"
 #include "../random_utils.hpp"
@@ -97,10 +98,7 @@ IQRouter::IQRouter(Configuration const &config, Module *parent,
       _packets_to_watch.insert(watch_packets[i]);
   }
   vector<int> watch_routers = config.GetIntArray("watch_routers");
-  for (size_t i = 0; i < watch_routers.size(); ++i)
-  {
-      _routers_to_watch.insert(watch_routers[i]);
-  }
+  _watched = find(watch_routers.begin(), watch_routers.end(), GetID()) != watch_routers.end();
   // Routing
   string const rf = config.GetStr("routing_function") + "_" + config.GetStr("topology");
   map<string, tRoutingFunction>::const_iterator rf_iter = gRoutingFunctionMap.find(rf);
@@ -221,6 +219,15 @@ IQRouter::IQRouter(Configuration const &config, Module *parent,
   _switch_hold_out.resize(_outputs * _output_speedup, -1);
   _switch_hold_vc.resize(_inputs * _input_speedup, -1);
 
+  _mcast_empty_vc.resize(_outputs, -1);
+  _mcast_sw_claim.resize(_outputs * _output_speedup, -1);
+
+  _route_vcs.Resize(_inputs, _vcs);
+  _route_vcs_multi.Resize(_inputs, _vcs);
+  _vc_alloc_vcs.Resize(_inputs, _vcs);
+  _sw_hold_vcs.Resize(_inputs, _vcs);
+  _sw_alloc_vcs.Resize(_inputs, _vcs);
+
   _bufferMonitor = new BufferMonitor(inputs, _classes);
   _switchMonitor = new SwitchMonitor(inputs, outputs, _classes);
 
@@ -291,35 +298,29 @@ void IQRouter::_InternalStep()
     _InputQueuing();
     bool activity = !_proc_credits.empty();
 
+    // Unicast and multicast VCs go through one evaluate pass: each allocator
+    // is cleared once per cycle, multicast VC allocation runs ahead of the
+    // unicast VC allocator so it sees the buffers already taken, and
+    // multicast switch requests share a single Allocate() with unicast ones.
 
-    activity = _Multi_Internal_Sub_Step(activity);
-
-    activity = _Internal_Sub_Step(activity);
-
-
-    _active = activity;
-
-    _OutputQueuing();
-
-    _bufferMonitor->cycle();
-    _switchMonitor->cycle();
-}
+    if (!_route_vcs_multi.Empty())
+        _RouteEvaluateMulti();
 
-bool IQRouter::_Internal_Sub_Step(bool activity)
-{
-    if (!_route_vcs.empty())
+    if (!_route_vcs.Empty())
         _RouteEvaluate();
 
     if (_vc_allocator)
     {
         _vc_allocator->Clear();
-        if (!_vc_alloc_vcs.empty())
+        if (!_vc_alloc_vcs_multi.empty())
+            _VCAllocEvaluateMulti();
+        if (!_vc_alloc_vcs.Empty())
             _VCAllocEvaluate();
     }
 
     if (_hold_switch_for_packet)
     {
-        if (!_sw_hold_vcs.empty())
+        if (!_sw_hold_vcs.Empty())
             _SWHoldEvaluate();
     }
 
@@ -328,37 +329,64 @@ bool IQRouter::_Internal_Sub_Step(bool activity)
     if (_spec_sw_allocator)
         _spec_sw_allocator->Clear();
 
-    if (!_sw_alloc_vcs.empty())
+    if (!_sw_alloc_vcs_multi.empty())
+        _SWAllocEvaluateMulti();
+
+    if (!_sw_alloc_vcs.Empty())
         _SWAllocEvaluate();
 
+    if (!_sw_alloc_vcs_multi.empty())
+        _SWAllocGrantMulti();
+
+    if (!_route_vcs_multi.Empty())
+    {
+        _RouteUpdateMulti();
+        activity = activity || !_route_vcs_multi.Empty();
+    }
+
+    if (!_vc_alloc_vcs_multi.empty())
+    {
+        _VCAllocUpdateMulti();
+        activity = activity || !_vc_alloc_vcs_multi.empty();
+    }
+
+    if (!_sw_alloc_vcs_multi.empty())
+    {
+        _SWAllocUpdateMulti();
+        activity = activity || !_sw_alloc_vcs_multi.empty();
+    }
+
+    // multicast copies scheduled above traverse the crossbar with the same
+    // delay as before; unicast grants are scheduled after the evaluate, as
+    // they always have been
     if (!_crossbar_flits.empty())
         _SwitchEvaluate();
 
-    if (!_route_vcs.empty())
+    if (!_route_vcs.Empty())
     {
         _RouteUpdate();
-        activity = activity || !_route_vcs.empty();
+        activity = activity || !_route_vcs.Empty();
     }
 
-    if (!_vc_alloc_vcs.empty())
+    if (!_vc_alloc_vcs.Empty())
     {
         _VCAllocUpdate();
-        activity = activity || !_vc_alloc_vcs.empty();
+        activity = activity || !_vc_alloc_vcs.Empty();
     }
 
     if (_hold_switch_for_packet)
     {
-        if (!_sw_hold_vcs.empty())
+        if (!_sw_hold_vcs.Empty())
         {
             _SWHoldUpdate();
-            activity = activity || !_sw_hold_vcs.empty();
+            activity = activity || !_sw_hold_vcs.Empty();
         }
     }
 
-    if (!_sw_alloc_vcs.empty())
+    if (!_sw_alloc_vcs.Empty())
     {
         _SWAllocUpdate();
-        activity = activity || !_sw_alloc_vcs.empty();
+        activity = activity || !_sw_alloc_vcs.Empty();
     }
 
     if (!_crossbar_flits.empty())
@@ -367,56 +395,14 @@ bool IQRouter::_Internal_Sub_Step(bool activity)
         activity = activity || !_crossbar_flits.empty();
     }
 
-    return activity;
-}
-
-
-bool IQRouter::_Multi_Internal_Sub_Step(bool activity)
-{
-    if (!_route_vcs_multi.empty())
-        _RouteEvaluateMulti();
-
-    if (_vc_allocator)
-    {
-        _vc_allocator->Clear();
-        if (!_vc_alloc_vcs_multi.empty())
-            _VCAllocEvaluateMulti();
-    }
-
-    _sw_allocator->Clear();
-
-    if (!_sw_alloc_vcs_multi.empty())
-        _SWAllocEvaluateMulti();
-
-    // if (!_crossbar_flits_multi.empty())
-    //   _SwitchEvaluateMulti();
-
-    if (!_route_vcs_multi.empty())
-    {
-        _RouteUpdateMulti();
-        activity = activity || !_route_vcs_multi.empty();
-    }
-
-    if (!_vc_alloc_vcs_multi.empty())
-    {
-        _VCAllocUpdateMulti();
-        activity = activity || !_vc_alloc_vcs_multi.empty();
-    }
-
-    if (!_sw_alloc_vcs_multi.empty())
-    {
-        _SWAllocUpdateMulti();
-        activity = activity || !_sw_alloc_vcs_multi.empty();
-    }
+    _active = activity;
 
-    // if (!_crossbar_flits_multi.empty())
-    // {
-    //   _SwitchUpdateMulti();
-    //   activity = activity || !_crossbar_flits_multi.empty();
-    // }
+    _OutputQueuing();
 
-    return activity;
+    _bufferMonitor->cycle();
+    _switchMonitor->cycle();
 }
+
 void IQRouter::WriteOutputs()
 {
   _SendFlits();
@@ -440,7 +426,7 @@ bool IQRouter::_ReceiveFlits()
       ++_received_flits[f->cl][input];
 #endif
 
-      if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+      if (f->watch || (_IsWatched()))
       {
         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                    << " Received flit " << f->id
@@ -492,7 +478,7 @@ void IQRouter::_InputQueuing()
 
     Buffer *const cur_buf = _buf[input];
     f->cur_router = GetID();
-    if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    if (f->watch || (_IsWatched()))
     {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID()   
                  << " adding flit " << f->id 
@@ -537,17 +523,17 @@ void IQRouter::_InputQueuing()
         {
           // if(GetID() == 41)
           //   cout<<"fid "<<f->id<<endl;
-          _route_vcs_multi.push_back(make_pair(-1, make_pair(input, vc)));
+          _route_vcs_multi.Push(input, vc);
         }
         else
         {
-          _route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+          _route_vcs.Push(input, vc);
         }
         
       }
       else
       {
-        if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+        if (f->watch || (_IsWatched()))
         {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                      << "Using precomputed lookahead routing information for VC " << vc
@@ -560,13 +546,11 @@ void IQRouter::_InputQueuing()
         cur_buf->SetState(vc, VC::vc_alloc);
         if (_speculative)
         {
-          _sw_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                                                          -1)));
+          _sw_alloc_vcs.Push(input, vc);
         }
         if (_vc_allocator)
         {
-          _vc_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                                                          -1)));
+          _vc_alloc_vcs.Push(input, vc);
         }
         if (_noq)
         {
@@ -580,21 +564,20 @@ void IQRouter::_InputQueuing()
     {
       if (_switch_hold_vc[input * _input_speedup + vc % _input_speedup] == vc)
       {
-        _sw_hold_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                                                       -1)));
+        _sw_hold_vcs.Push(input, vc);
       }//todo add mcast
       else
       {
         if (f->mflag)
         {
-          vector<int> Outpair = cur_buf->GetMulticastOutpair(vc);
+          vector<int> const & Outpair = cur_buf->GetMulticastOutpair(vc);
           for(int i = 0; i < Outpair.size(); i++)
           {
             int output_and_vc = Outpair[i];
             _sw_alloc_vcs_multi.push_back(make_pair(-1, make_pair(make_pair(make_pair(input, vc), output_and_vc),        
                                                           -1)));
           }
-          if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+          if (f->watch || (_IsWatched()))
           {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                   << " push into mcast switch alloc in input qeueing, fid = " << f->id << " output pair size is "
@@ -604,9 +587,8 @@ void IQRouter::_InputQueuing()
 
         }
         else{
-          _sw_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-                                                        -1)));
-          if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+          _sw_alloc_vcs.Push(input, vc);
+          if (f->watch || (_IsWatched()))
           {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                   << "push into unicast switch alloc in input qeueing, fid = " << f->id << endl;
@@ -640,9 +622,8 @@ void IQRouter::_InputQueuing()
     BufferState *const dest_buf = _next_buf[output];
 
 #ifdef TRACK_FLOWS
-    for (set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter)
+    for (int vc = c->FirstVC(); vc >= 0; vc = c->NextVC(vc))
     {
-      int const vc = *iter;
       assert(!_outstanding_classes[output][vc].empty());
       int cl = _outstanding_classes[output][vc].front();
       _outstanding_classes[output][vc].pop();
@@ -671,21 +652,12 @@ void IQRouter::_RouteEvaluate()
 {
   assert(_routing_delay);
 
-  for (deque<pair<int, pair<int, int> > >::iterator iter = _route_vcs.begin();
-       iter != _route_vcs.end();
-       ++iter)
+  for (int slot = _route_vcs.Launch(GetSimTime() + _routing_delay - 1); slot >= 0; slot = _route_vcs.NextReady(slot))
   {
 
-    int const time = iter->first;
-    if (time >= 0)
-    {
-      break;
-    }
-    iter->first = GetSimTime() + _routing_delay - 1;
-
-    int const input = iter->second.first;
+    int const input = _route_vcs.Input(slot);
     assert((input >= 0) && (input < _inputs));
-    int const vc = iter->second.second;
+    int const vc = _route_vcs.VC(slot);
     assert((vc >= 0) && (vc < _vcs));
 
     Buffer const *const cur_buf = _buf[input];
@@ -697,7 +669,7 @@ void IQRouter::_RouteEvaluate()
     assert(f->vc == vc);
     assert(f->head);
 
-    if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    if (f->watch || (_IsWatched()))
     {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                  << " beginning routing for VC " << vc
@@ -712,21 +684,13 @@ void IQRouter::_RouteUpdate()
 {
   assert(_routing_delay);
 
-  while (!_route_vcs.empty())
+  for (int slot = _route_vcs.FirstReady(GetSimTime()); slot >= 0; slot = _route_vcs.FirstReady(GetSimTime()))
   {
+    assert(GetSimTime() == _route_vcs.ReadyTime());
 
-    pair<int, pair<int, int> > const &item = _route_vcs.front();
-
-    int const time = item.first;
-    if ((time < 0) || (GetSimTime() < time))
-    {
-      break;
-    }
-    assert(GetSimTime() == time);
-
-    int const input = item.second.first;
+    int const input = _route_vcs.Input(slot);
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.second;
+    int const vc = _route_vcs.VC(slot);
     assert((vc >= 0) && (vc < _vcs));
 
     Buffer *const cur_buf = _buf[input];
@@ -738,7 +702,7 @@ void IQRouter::_RouteUpdate()
     assert(f->vc == vc);
     assert(f->head);
 
-    if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    if (f->watch || (_IsWatched()))
     {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                  << " completed routing for VC " << vc
@@ -751,14 +715,14 @@ void IQRouter::_RouteUpdate()
     cur_buf->SetState(vc, VC::vc_alloc);
     if (_speculative)
     {
-      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second, -1)));
+      _sw_alloc_vcs.Push(input, vc);
     }
     if (_vc_allocator)
     {
-      _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second, -1)));
+      _vc_alloc_vcs.Push(input, vc);
     }
     // NOTE: No need to handle NOQ here, as it requires lookahead routing!
-    _route_vcs.pop_front();
+    _route_vcs.Pop();
   }
 }
 
@@ -773,23 +737,15 @@ void IQRouter::_VCAllocEvaluate()
 
   bool watched = false;
 
-  for (deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _vc_alloc_vcs.begin();
-       iter != _vc_alloc_vcs.end();
-       ++iter)
+  for (int slot = _vc_alloc_vcs.FirstPending(); slot >= 0; slot = _vc_alloc_vcs.NextPending(slot))
   {
 
-    int const time = iter->first;
-    if (time >= 0)
-    {
-      break;
-    }
-
-    int const input = iter->second.first.first;
+    int const input = _vc_alloc_vcs.Input(slot);
     assert((input >= 0) && (input < _inputs));
-    int const vc = iter->second.first.second;
+    int const vc = _vc_alloc_vcs.VC(slot);
     assert((vc >= 0) && (vc < _vcs));
 
-    assert(iter->second.second == -1);
+    assert(_vc_alloc_vcs.Result(slot) == -1);
 
     Buffer const *const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -800,7 +756,7 @@ void IQRouter::_VCAllocEvaluate()
     assert(f->vc == vc);
     assert(f->head);
 
-    if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    if (f->watch || (_IsWatched()))
     {
       // cout<<"TIme is "<<time<<endl;
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
@@ -814,7 +770,7 @@ void IQRouter::_VCAllocEvaluate()
     assert(route_set);
 
     int const out_priority = cur_buf->GetPriority(vc);
-    set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+    OutputSet const & setlist = route_set->GetSet();
 
     bool elig = false;
     bool cred = false;
@@ -822,7 +778,7 @@ void IQRouter::_VCAllocEvaluate()
 
     assert(!_noq || (setlist.size() == 1));
 
-    for (set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+    for (OutputSet::const_iterator iset = setlist.begin();
          iset != setlist.end();
          ++iset)
     {
@@ -869,7 +825,7 @@ void IQRouter::_VCAllocEvaluate()
 
         if (!dest_buf->IsAvailableFor(out_vc))
         {
-          if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+          if (f->watch || (_IsWatched()))
           {
             int const use_input_and_vc = dest_buf->UsedBy(out_vc);
             int const use_input = use_input_and_vc / _vcs;
@@ -898,7 +854,7 @@ void IQRouter::_VCAllocEvaluate()
           elig = true;
           if (_vc_busy_when_full && dest_buf->IsFullFor(out_vc))
           {
-            if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+            if (f->watch || (_IsWatched()))
               *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                          << "  VC " << out_vc
                          << " at output " << out_port
@@ -909,7 +865,7 @@ void IQRouter::_VCAllocEvaluate()
           else
           {
             cred = true;
-            if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+            if (f->watch || (_IsWatched()))
             {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                          << "  Requesting VC " << out_vc
@@ -928,15 +884,15 @@ void IQRouter::_VCAllocEvaluate()
     }
     if (!elig)
     {
-      iter->second.second = STALL_BUFFER_BUSY;
+      _vc_alloc_vcs.Result(slot) = STALL_BUFFER_BUSY;
     }
     else if (_vc_busy_when_full && !cred)
     {
-      iter->second.second = reserved ? STALL_BUFFER_RESERVED : STALL_BUFFER_FULL;
+      _vc_alloc_vcs.Result(slot) = reserved ? STALL_BUFFER_RESERVED : STALL_BUFFER_FULL;
     }
   }
 
-  if (watched && (_routers_to_watch.count(GetID()) > 0))
+  if (watched && (_IsWatched()))
   {
     *gWatchOut << GetSimTime() << " | " << _vc_allocator->FullName() << " | " << " rid = " <<GetID() ;
     _vc_allocator->PrintRequests(gWatchOut);
@@ -944,35 +900,26 @@ void IQRouter::_VCAllocEvaluate()
 
   _vc_allocator->Allocate();
 
-  if (watched && (_routers_to_watch.count(GetID()) > 0))
+  if (watched && (_IsWatched()))
   {
     *gWatchOut << GetSimTime() << " | " << _vc_allocator->FullName() << " | " << " rid = " <<GetID() ;
     _vc_allocator->PrintGrants(gWatchOut);
   }
 
-  for (deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _vc_alloc_vcs.begin();
-       iter != _vc_alloc_vcs.end();
-       ++iter)
+  for (int slot = _vc_alloc_vcs.Launch(GetSimTime() + _vc_alloc_delay - 1); slot >= 0; slot = _vc_alloc_vcs.NextReady(slot))
   {
 
-    int const time = iter->first;
-    if (time >= 0)
-    {
-      break;
-    }
-    iter->first = GetSimTime() + _vc_alloc_delay - 1;
-
-    int const input = iter->second.first.first;
+    int const input = _vc_alloc_vcs.Input(slot);
     assert((input >= 0) && (input < _inputs));
-    int const vc = iter->second.first.second;
+    int const vc = _vc_alloc_vcs.VC(slot);
     assert((vc >= 0) && (vc < _vcs));
 
-    if (iter->second.second < -1)
+    if (_vc_alloc_vcs.Result(slot) < -1)
     {
       continue;
     }
 
-    assert(iter->second.second == -1);
+    assert(_vc_alloc_vcs.Result(slot) == -1);
 
     Buffer const *const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -994,7 +941,7 @@ void IQRouter::_VCAllocEvaluate()
       int const match_vc = output_and_vc % _vcs;
       assert((match_vc >= 0) && (match_vc < _vcs));
 
-      if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+      if (f->watch || (_IsWatched()))
       {
         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                    << " Assigning VC " << match_vc
@@ -1004,12 +951,12 @@ void IQRouter::_VCAllocEvaluate()
                    << "." << endl;
       }
 
-      iter->second.second = output_and_vc;
+      _vc_alloc_vcs.Result(slot) = output_and_vc;
     }
     else
     {
 
-      if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+      if (f->watch || (_IsWatched()))
       {
         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                    << " VC allocation failed for VC " << vc
@@ -1017,7 +964,7 @@ void IQRouter::_VCAllocEvaluate()
                    << "." << endl;
       }
 
-      iter->second.second = STALL_BUFFER_CONFLICT;
+      _vc_alloc_vcs.Result(slot) = STALL_BUFFER_CONFLICT;
     }
   }
 
@@ -1026,21 +973,12 @@ void IQRouter::_VCAllocEvaluate()
     return;
   }
 
-  for (deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _vc_alloc_vcs.begin();
-       iter != _vc_alloc_vcs.end();
-       ++iter)
+  for (int slot = _vc_alloc_vcs.FirstReady(GetSimTime()); slot >= 0; slot = _vc_alloc_vcs.NextReady(slot))
   {
 
-    int const time = iter->first;
-    assert(time >= 0);
-    if (GetSimTime() < time)
-    {
-      break;
-    }
-
-    assert(iter->second.second != -1);
+    assert(_vc_alloc_vcs.Result(slot) != -1);
 
-    int const output_and_vc = iter->second.second;
+    int const output_and_vc = _vc_alloc_vcs.Result(slot);
 
     if (output_and_vc >= 0)
     {
@@ -1052,9 +990,9 @@ void IQRouter::_VCAllocEvaluate()
 
       BufferState const *const dest_buf = _next_buf[match_output];
 
-      int const input = iter->second.first.first;
+      int const input = _vc_alloc_vcs.Input(slot);
       assert((input >= 0) && (input < _inputs));
-      int const vc = iter->second.first.second;
+      int const vc = _vc_alloc_vcs.VC(slot);
       assert((vc >= 0) && (vc < _vcs));
 
       Buffer const *const cur_buf = _buf[input];
@@ -1077,11 +1015,11 @@ void IQRouter::_VCAllocEvaluate()
                      << " at output " << match_output
                      << " is no longer available." << endl;
         }
-        iter->second.second = STALL_BUFFER_BUSY;
+        _vc_alloc_vcs.Result(slot) = STALL_BUFFER_BUSY;
       }
       else if (_vc_busy_when_full && dest_buf->IsFullFor(match_vc))
       {
-        if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+        if (f->watch || (_IsWatched()))
         {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                      << " Discarding previously generated grant for VC " << vc
@@ -1090,7 +1028,7 @@ void IQRouter::_VCAllocEvaluate()
                      << " at output " << match_output
                      << " has become full." << endl;
         }
-        iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+        _vc_alloc_vcs.Result(slot) = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
       }
     }
   }
@@ -1100,24 +1038,16 @@ void IQRouter::_VCAllocUpdate()
 {
   assert(_vc_allocator);
 
-  while (!_vc_alloc_vcs.empty())
+  for (int slot = _vc_alloc_vcs.FirstReady(GetSimTime()); slot >= 0; slot = _vc_alloc_vcs.FirstReady(GetSimTime()))
   {
+    assert(GetSimTime() == _vc_alloc_vcs.ReadyTime());
 
-    pair<int, pair<pair<int, int>, int> > const &item = _vc_alloc_vcs.front();
-
-    int const time = item.first;
-    if ((time < 0) || (GetSimTime() < time))
-    {
-      break;
-    }
-    assert(GetSimTime() == time);
-
-    int const input = item.second.first.first;
+    int const input = _vc_alloc_vcs.Input(slot);
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.first.second;
+    int const vc = _vc_alloc_vcs.VC(slot);
     assert((vc >= 0) && (vc < _vcs));
 
-    assert(item.second.second != -1);
+    assert(_vc_alloc_vcs.Result(slot) != -1);
 
     Buffer *const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -1128,7 +1058,7 @@ void IQRouter::_VCAllocUpdate()
     assert(f->vc == vc);
     assert(f->head);
 
-    if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    if (f->watch || (_IsWatched()))
     {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                  << " Completed VC allocation for VC " << vc
@@ -1137,7 +1067,7 @@ void IQRouter::_VCAllocUpdate()
                  << ")." << endl;
     }
 
-    int const output_and_vc = item.second.second;
+    int const output_and_vc = _vc_alloc_vcs.Result(slot);
 
     if (output_and_vc >= 0)
     {
@@ -1147,7 +1077,7 @@ void IQRouter::_VCAllocUpdate()
       int const match_vc = output_and_vc % _vcs;
       assert((match_vc >= 0) && (match_vc < _vcs));
 
-      if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+      if (f->watch || (_IsWatched()))
       {
         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                    << "  Acquiring assigned VC " << match_vc
@@ -1164,12 +1094,12 @@ void IQRouter::_VCAllocUpdate()
       cur_buf->SetState(vc, VC::active);
       if (!_speculative)
       {
-        _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+        _sw_alloc_vcs.Push(input, vc);
       }
     }
     else
     {
-      if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+      if (f->watch || (_IsWatched()))
       {
         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                    << "  No output VC allocated." << endl;
@@ -1188,9 +1118,9 @@ void IQRouter::_VCAllocUpdate()
       }
 #endif
 
-      _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+      _vc_alloc_vcs.Push(input, vc);
     }
-    _vc_alloc_vcs.pop_front();
+    _vc_alloc_vcs.Pop();
   }
 }
 
@@ -1203,24 +1133,15 @@ void IQRouter::_SWHoldEvaluate()
 {
   assert(_hold_switch_for_packet);
 
-  for (deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_hold_vcs.begin();
-       iter != _sw_hold_vcs.end();
-       ++iter)
+  for (int slot = _sw_hold_vcs.Launch(GetSimTime()); slot >= 0; slot = _sw_hold_vcs.NextReady(slot))
   {
 
-    int const time = iter->first;
-    if (time >= 0)
-    {
-      break;
-    }
-    iter->first = GetSimTime();
-
-    int const input = iter->second.first.first;
+    int const input = _sw_hold_vcs.Input(slot);
     assert((input >= 0) && (input < _inputs));
-    int const vc = iter->second.first.second;
+    int const vc = _sw_hold_vcs.VC(slot);
     assert((vc >= 0) && (vc < _vcs));
 
-    assert(iter->second.second == -1);
+    assert(_sw_hold_vcs.Result(slot) == -1);
 
     Buffer const *const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -1230,7 +1151,7 @@ void IQRouter::_SWHoldEvaluate()
     assert(f);
     assert(f->vc == vc);
 
-    if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    if (f->watch || (_IsWatched()))
     {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                  << " beginning held switch allocation for VC " << vc
@@ -1254,7 +1175,7 @@ void IQRouter::_SWHoldEvaluate()
 
     if (dest_buf->IsFullFor(match_vc))
     {
-      if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+      if (f->watch || (_IsWatched()))
       {
         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                    << "  Unable to reuse held connection from input " << input
@@ -1263,11 +1184,11 @@ void IQRouter::_SWHoldEvaluate()
                    << "." << (expanded_output % _output_speedup)
                    << ": No credit available." << endl;
       }
-      iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+      _sw_hold_vcs.Result(slot) = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
     }
     else
     {
-      if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+      if (f->watch || (_IsWatched()))
       {
         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                    << "  Reusing held connection from input " << input
@@ -1276,7 +1197,7 @@ void IQRouter::_SWHoldEvaluate()
                    << "." << (expanded_output % _output_speedup)
                    << "." << endl;
       }
-      iter->second.second = expanded_output;
+      _sw_hold_vcs.Result(slot) = expanded_output;
     }
   }
 }
@@ -1285,24 +1206,16 @@ void IQRouter::_SWHoldUpdate()
 {
   assert(_hold_switch_for_packet);
 
-  while (!_sw_hold_vcs.empty())
+  for (int slot = _sw_hold_vcs.FirstReady(GetSimTime()); slot >= 0; slot = _sw_hold_vcs.FirstReady(GetSimTime()))
   {
+    assert(GetSimTime() == _sw_hold_vcs.ReadyTime());
 
-    pair<int, pair<pair<int, int>, int> > const &item = _sw_hold_vcs.front();
-
-    int const time = item.first;
-    if (time < 0)
-    {
-      break;
-    }
-    assert(GetSimTime() == time);
-
-    int const input = item.second.first.first;
+    int const input = _sw_hold_vcs.Input(slot);
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.first.second;
+    int const vc = _sw_hold_vcs.VC(slot);
     assert((vc >= 0) && (vc < _vcs));
 
-    assert(item.second.second != -1);
+    assert(_sw_hold_vcs.Result(slot) != -1);
 
     Buffer *const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -1312,7 +1225,7 @@ void IQRouter::_SWHoldUpdate()
     assert(f);
     assert(f->vc == vc);
 
-    if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    if (f->watch || (_IsWatched()))
     {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                  << " completed held switch allocation for VC " << vc
@@ -1324,7 +1237,7 @@ void IQRouter::_SWHoldUpdate()
     int const expanded_input = input * _input_speedup + vc % _input_speedup;
     assert(_switch_hold_vc[expanded_input] == vc);
 
-    int const expanded_output = item.second.second;
+    int const expanded_output = _sw_hold_vcs.Result(slot);
 
     if (expanded_output >= 0 && (_output_buffer_size == -1 || _output_buffer[expanded_output / _output_speedup].size() < size_t(_output_buffer_size)))
     {
@@ -1341,7 +1254,7 @@ void IQRouter::_SWHoldUpdate()
 
       BufferState *const dest_buf = _next_buf[output];
 
-      if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+      if (f->watch || (_IsWatched()))
       {
         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                    << "  Scheduling switch connection from input " << input
@@ -1372,7 +1285,7 @@ void IQRouter::_SWHoldUpdate()
         {
           if (_noq)
           {
-            if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+            if (f->watch || (_IsWatched()))
             {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                          << "Updating lookahead routing information for flit " << f->id
@@ -1392,7 +1305,7 @@ void IQRouter::_SWHoldUpdate()
           }
           else
           {
-            if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+            if (f->watch || (_IsWatched()))
             {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                          << "Updating lookahead routing information for flit " << f->id
@@ -1421,11 +1334,11 @@ void IQRouter::_SWHoldUpdate()
       {
         _out_queue_credits.insert(make_pair(input, Credit::New()));
       }
-      _out_queue_credits.find(input)->second->vc.insert(vc);
+      _out_queue_credits.find(input)->second->AddVC(vc);
 
       if (cur_buf->Empty(vc))
       {
-        if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+        if (f->watch || (_IsWatched()))
         {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                      << "  Cancelling held connection from input " << input
@@ -1450,7 +1363,7 @@ void IQRouter::_SWHoldUpdate()
         if (f->tail)
         {
           assert(nf->head);
-          if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+          if (f->watch || (_IsWatched()))
           {
             *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                        << "  Cancelling held connection from input " << input
@@ -1466,8 +1379,8 @@ void IQRouter::_SWHoldUpdate()
           {
             cur_buf->SetState(vc, VC::routing);
             if (nf->mflag) {
-                _route_vcs_multi.push_back(make_pair(-1, item.second.first));
-                if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+                _route_vcs_multi.Push(input, vc);
+                if (f->watch || (_IsWatched()))
                 {
                     *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " << GetID()
                         << "  flit " << nf->id
@@ -1477,8 +1390,8 @@ void IQRouter::_SWHoldUpdate()
             
             else
             {
-                _route_vcs.push_back(make_pair(-1, item.second.first));
-                if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+                _route_vcs.Push(input, vc);
+                if (f->watch || (_IsWatched()))
                 {
                     *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " << GetID()
                         << "  flit " << nf->id
@@ -1500,13 +1413,11 @@ void IQRouter::_SWHoldUpdate()
             cur_buf->SetState(vc, VC::vc_alloc);
             if (_speculative)
             {
-              _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                                                              -1)));
+              _sw_alloc_vcs.Push(input, vc);
             }
             if (_vc_allocator)
             {
-              _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                                                              -1)));
+              _vc_alloc_vcs.Push(input, vc);
             }
             if (_noq)
             {
@@ -1516,8 +1427,7 @@ void IQRouter::_SWHoldUpdate()
         }
         else
         {
-          _sw_hold_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                                                         -1)));
+          _sw_hold_vcs.Push(input, vc);
         }
       }
     }
@@ -1530,7 +1440,7 @@ void IQRouter::_SWHoldUpdate()
       int const held_expanded_output = _switch_hold_in[expanded_input];
       assert(held_expanded_output >= 0);
 
-      if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+      if (f->watch || (_IsWatched()))
       {
         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                    << "  Cancelling held connection from input " << input
@@ -1542,10 +1452,9 @@ void IQRouter::_SWHoldUpdate()
       _switch_hold_vc[expanded_input] = -1;
       _switch_hold_in[expanded_input] = -1;
       _switch_hold_out[held_expanded_output] = -1;
-      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                                                      -1)));
+      _sw_alloc_vcs.Push(input, vc);
     }
-    _sw_hold_vcs.pop_front();
+    _sw_hold_vcs.Pop();
   }
 }
 
@@ -1603,7 +1512,7 @@ bool IQRouter::_SWAllocAddReq(int input, int vc, int output)
       if (RoundRobinArbiter::Supersedes(vc, prio, req.label, req.in_pri,
                                         _sw_rr_offset[expanded_input], _vcs)) //Only body and tail
       {
-        if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+        if (f->watch || (_IsWatched()))
         {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                      << "  Replacing earlier request from VC " << req.label
@@ -1619,7 +1528,7 @@ bool IQRouter::_SWAllocAddReq(int input, int vc, int output)
         return true;
       }
 
-      if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+      if (f->watch || (_IsWatched()))
       {
         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                    << "  Output " << output
@@ -1632,7 +1541,7 @@ bool IQRouter::_SWAllocAddReq(int input, int vc, int output)
       return false;
     }
 
-    if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    if (f->watch || (_IsWatched()))
     {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                  << "  Requesting output " << output
@@ -1645,7 +1554,7 @@ bool IQRouter::_SWAllocAddReq(int input, int vc, int output)
     return true;
   }
 
-  if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+  if (f->watch || (_IsWatched()))
   {
     *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                << "  Ignoring output " << output
@@ -1674,23 +1583,15 @@ void IQRouter::_SWAllocEvaluate()
 {
   bool watched = false;
 
-  for (deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_alloc_vcs.begin();
-       iter != _sw_alloc_vcs.end();
-       ++iter)
+  for (int slot = _sw_alloc_vcs.FirstPending(); slot >= 0; slot = _sw_alloc_vcs.NextPending(slot))
   {
 
-    int const time = iter->first;
-    if (time >= 0)
-    {
-      break;
-    }
-
-    int const input = iter->second.first.first;
+    int const input = _sw_alloc_vcs.Input(slot);
     assert((input >= 0) && (input < _inputs));
-    int const vc = iter->second.first.second;
+    int const vc = _sw_alloc_vcs.VC(slot);
     assert((vc >= 0) && (vc < _vcs));
 
-    assert(iter->second.second == -1);
+    assert(_sw_alloc_vcs.Result(slot) == -1);
 
     assert(_switch_hold_vc[input * _input_speedup + vc % _input_speedup] != vc);
 
@@ -1704,7 +1605,7 @@ void IQRouter::_SWAllocEvaluate()
     assert(f);
     assert(f->vc == vc);
 
-    if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    if (f->watch || (_IsWatched()))
     {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                  << " beginning switch allocation for VC " << vc
@@ -1725,7 +1626,7 @@ void IQRouter::_SWAllocEvaluate()
 
       if (dest_buf->IsFullFor(dest_vc) || (_output_buffer_size != -1 && _output_buffer[dest_output].size() >= (size_t)(_output_buffer_size)))
       {
-        if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+        if (f->watch || (_IsWatched()))
         {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                      << "  VC " << dest_vc
@@ -1737,7 +1638,7 @@ void IQRouter::_SWAllocEvaluate()
                      << " output_buffer[dest_output].size() " << _output_buffer[dest_output].size()
                      << endl;
         }
-        iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+        _sw_alloc_vcs.Result(slot) = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
         continue;
       }
       bool const requested = _SWAllocAddReq(input, vc, dest_output);
@@ -1755,11 +1656,11 @@ void IQRouter::_SWAllocEvaluate()
     OutputSet const *const route_set = cur_buf->GetRouteSet(vc);
     assert(route_set);
 
-    set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+    OutputSet const & setlist = route_set->GetSet();
 
     assert(!_noq || (setlist.size() == 1));
 
-    for (set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+    for (OutputSet::const_iterator iset = setlist.begin();
          iset != setlist.end();
          ++iset)
     {
@@ -1817,23 +1718,23 @@ void IQRouter::_SWAllocEvaluate()
 
       if (_spec_check_elig && !elig)
       {
-        if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+        if (f->watch || (_IsWatched()))
         {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                      << "  Output " << dest_output
                      << " has no suitable VCs available." << endl;
         }
-        iter->second.second = STALL_BUFFER_BUSY;
+        _sw_alloc_vcs.Result(slot) = STALL_BUFFER_BUSY;
       }
       else if (_spec_check_cred && !cred)
       {
-        if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+        if (f->watch || (_IsWatched()))
         {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                      << "  All suitable VCs at output " << dest_output
                      << " are full." << endl;
         }
-        iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+        _sw_alloc_vcs.Result(slot) = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
       }
       else
       {
@@ -1869,29 +1770,20 @@ void IQRouter::_SWAllocEvaluate()
     }
   }
 
-  for (deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_alloc_vcs.begin();
-       iter != _sw_alloc_vcs.end();
-       ++iter)
+  for (int slot = _sw_alloc_vcs.Launch(GetSimTime() + _sw_alloc_delay - 1); slot >= 0; slot = _sw_alloc_vcs.NextReady(slot))
   {
 
-    int const time = iter->first;
-    if (time >= 0)
-    {
-      break;
-    }
-    iter->first = GetSimTime() + _sw_alloc_delay - 1;
-
-    int const input = iter->second.first.first;
+    int const input = _sw_alloc_vcs.Input(slot);
     assert((input >= 0) && (input < _inputs));
-    int const vc = iter->second.first.second;
+    int const vc = _sw_alloc_vcs.VC(slot);
     assert((vc >= 0) && (vc < _vcs));
 
-    if (iter->second.second < -1)
+    if (_sw_alloc_vcs.Result(slot) < -1)
     {
       continue;
     }
 
-    assert(iter->second.second == -1);
+    assert(_sw_alloc_vcs.Result(slot) == -1);
 
     Buffer const *const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -1912,7 +1804,7 @@ void IQRouter::_SWAllocEvaluate()
       int const granted_vc = _sw_allocator->ReadRequest(expanded_input, expanded_output);
       if (granted_vc == vc)
       {
-        if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+        if (f->watch || (_IsWatched()))
         {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                      << " assigning output " << (expanded_output / _output_speedup)
@@ -1923,18 +1815,18 @@ void IQRouter::_SWAllocEvaluate()
                      << "." << endl;
         }
         _sw_rr_offset[expanded_input] = (vc + _input_speedup) % _vcs;
-        iter->second.second = expanded_output;
+        _sw_alloc_vcs.Result(slot) = expanded_output;
       }
       else
       {
-        if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+        if (f->watch || (_IsWatched()))
         {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                      << "Switch allocation failed for VC " << vc
                      << " at input " << input
                      << ": Granted to VC " << granted_vc << "." << endl;
         }
-        iter->second.second = STALL_CROSSBAR_CONFLICT;
+        _sw_alloc_vcs.Result(slot) = STALL_CROSSBAR_CONFLICT;
       }
     }
     else if (_spec_sw_allocator)
@@ -1946,7 +1838,7 @@ void IQRouter::_SWAllocEvaluate()
         if (_spec_mask_by_reqs &&
             _sw_allocator->OutputHasRequests(expanded_output))
         {
-          if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+          if (f->watch || (_IsWatched()))
           {
             *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                        << " Discarding speculative grant for VC " << vc
@@ -1956,12 +1848,12 @@ void IQRouter::_SWAllocEvaluate()
                        << "." << (expanded_output % _output_speedup)
                        << " has non-speculative requests." << endl;
           }
-          iter->second.second = STALL_CROSSBAR_CONFLICT;
+          _sw_alloc_vcs.Result(slot) = STALL_CROSSBAR_CONFLICT;
         }
         else if (!_spec_mask_by_reqs &&
                  (_sw_allocator->InputAssigned(expanded_output) >= 0))
         {
-          if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+          if (f->watch || (_IsWatched()))
           {
             *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                        << " Discarding speculative grant for VC " << vc
@@ -1971,7 +1863,7 @@ void IQRouter::_SWAllocEvaluate()
                        << "." << (expanded_output % _output_speedup)
                        << " has a non-speculative grant." << endl;
           }
-          iter->second.second = STALL_CROSSBAR_CONFLICT;
+          _sw_alloc_vcs.Result(slot) = STALL_CROSSBAR_CONFLICT;
         }
         else
         {
@@ -1979,7 +1871,7 @@ void IQRouter::_SWAllocEvaluate()
                                                                  expanded_output);
           if (granted_vc == vc)
           {
-            if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+            if (f->watch || (_IsWatched()))
             {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                          << " assigning output " << (expanded_output / _output_speedup)
@@ -1990,25 +1882,25 @@ void IQRouter::_SWAllocEvaluate()
                          << "." << endl;
             }
             _sw_rr_offset[expanded_input] = (vc + _input_speedup) % _vcs;
-            iter->second.second = expanded_output;
+            _sw_alloc_vcs.Result(slot) = expanded_output;
           }
           else
           {
-            if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+            if (f->watch || (_IsWatched()))
             {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                          << "Switch allocation failed for VC " << vc
                          << " at input " << input
                          << ": Granted to VC " << granted_vc << "." << endl;
             }
-            iter->second.second = STALL_CROSSBAR_CONFLICT;
+            _sw_alloc_vcs.Result(slot) = STALL_CROSSBAR_CONFLICT;
           }
         }
       }
       else
       {
 
-        if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+        if (f->watch || (_IsWatched()))
         {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                      << "Switch allocation failed for VC " << vc
@@ -2016,13 +1908,13 @@ void IQRouter::_SWAllocEvaluate()
                      << ": No output granted." << endl;
         }
 
-        iter->second.second = STALL_CROSSBAR_CONFLICT;
+        _sw_alloc_vcs.Result(slot) = STALL_CROSSBAR_CONFLICT;
       }
     }
     else
     {
 
-      if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+      if (f->watch || (_IsWatched()))
       {
         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                    << "Switch allocation failed for VC " << vc
@@ -2030,7 +1922,7 @@ void IQRouter::_SWAllocEvaluate()
                    << ": No output granted." << endl;
       }
 
-      iter->second.second = STALL_CROSSBAR_CONFLICT;
+      _sw_alloc_vcs.Result(slot) = STALL_CROSSBAR_CONFLICT;
     }
   }
 
@@ -2040,20 +1932,12 @@ void IQRouter::_SWAllocEvaluate()
     return;
   }
 
-  for (deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_alloc_vcs.begin();
-       iter != _sw_alloc_vcs.end();
-       ++iter)
+  for (int slot = _sw_alloc_vcs.FirstReady(GetSimTime()); slot >= 0; slot = _sw_alloc_vcs.NextReady(slot))
   {
-    int const time = iter->first;
-    assert(time >= 0);
-    if (GetSimTime() < time)
-    {
-      break;
-    }
 
-    assert(iter->second.second != -1);
+    assert(_sw_alloc_vcs.Result(slot) != -1);
 
-    int const expanded_output = iter->second.second;
+    int const expanded_output = _sw_alloc_vcs.Result(slot);
 
     if (expanded_output >= 0)
     {
@@ -2063,10 +1947,10 @@ void IQRouter::_SWAllocEvaluate()
 
       BufferState const *const dest_buf = _next_buf[output];
 
-      int const input = iter->second.first.first;
+      int const input = _sw_alloc_vcs.Input(slot);
       assert((input >= 0) && (input < _inputs));
       assert((input % _output_speedup) == (expanded_output % _output_speedup));
-      int const vc = iter->second.first.second;
+      int const vc = _sw_alloc_vcs.VC(slot);
       assert((vc >= 0) && (vc < _vcs));
 
       int const expanded_input = input * _input_speedup + vc % _input_speedup;
@@ -2084,7 +1968,7 @@ void IQRouter::_SWAllocEvaluate()
       if ((_switch_hold_in[expanded_input] >= 0) ||
           (_switch_hold_out[expanded_output] >= 0))
       {
-        if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+        if (f->watch || (_IsWatched()))
         {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                      << " Discarding grant from input " << input
@@ -2107,7 +1991,7 @@ void IQRouter::_SWAllocEvaluate()
           }
           *gWatchOut << "." << endl;
         }
-        iter->second.second = STALL_CROSSBAR_CONFLICT;
+        _sw_alloc_vcs.Result(slot) = STALL_CROSSBAR_CONFLICT;
       }
       else if (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc))
       {
@@ -2123,7 +2007,7 @@ void IQRouter::_SWAllocEvaluate()
 
           if (output_and_vc < 0)
           {
-            if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+            if (f->watch || (_IsWatched()))
             {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                          << " Discarding grant from input " << input
@@ -2132,11 +2016,11 @@ void IQRouter::_SWAllocEvaluate()
                          << "." << (expanded_output % _output_speedup)
                          << " due to misspeculation." << endl;
             }
-            iter->second.second = -1; // stall is counted in VC allocation path!
+            _sw_alloc_vcs.Result(slot) = -1; // stall is counted in VC allocation path!
           }
           else if ((output_and_vc / _vcs) != output)
           {
-            if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+            if (f->watch || (_IsWatched()))
             {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                          << " Discarding grant from input " << input
@@ -2145,11 +2029,11 @@ void IQRouter::_SWAllocEvaluate()
                          << "." << (expanded_output % _output_speedup)
                          << " due to port mismatch between VC and switch allocator." << endl;
             }
-            iter->second.second = STALL_BUFFER_CONFLICT; // count this case as if we had failed allocation
+            _sw_alloc_vcs.Result(slot) = STALL_BUFFER_CONFLICT; // count this case as if we had failed allocation
           }
           else if (dest_buf->IsFullFor((output_and_vc % _vcs)))
           {
-            if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+            if (f->watch || (_IsWatched()))
             {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                          << " Discarding grant from input " << input
@@ -2158,7 +2042,7 @@ void IQRouter::_SWAllocEvaluate()
                          << "." << (expanded_output % _output_speedup)
                          << " due to lack of credit." << endl;
             }
-            iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+            _sw_alloc_vcs.Result(slot) = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
           }
         }
         else
@@ -2167,7 +2051,7 @@ void IQRouter::_SWAllocEvaluate()
           OutputSet const *const route_set = cur_buf->GetRouteSet(vc);
           assert(route_set);
 
-          set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+          OutputSet const & setlist = route_set->GetSet();
 
           bool busy = true;
           bool full = true;
@@ -2175,7 +2059,7 @@ void IQRouter::_SWAllocEvaluate()
 
           assert(!_noq || (setlist.size() == 1));
 
-          for (set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+          for (OutputSet::const_iterator iset = setlist.begin();
                iset != setlist.end();
                ++iset)
           {
@@ -2226,7 +2110,7 @@ void IQRouter::_SWAllocEvaluate()
 
           if (busy)
           {
-            if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+            if (f->watch || (_IsWatched()))
             {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                          << " Discarding grant from input " << input
@@ -2235,11 +2119,11 @@ void IQRouter::_SWAllocEvaluate()
                          << "." << (expanded_output % _output_speedup)
                          << " because no suitable output VC for piggyback allocation is available." << endl;
             }
-            iter->second.second = STALL_BUFFER_BUSY;
+            _sw_alloc_vcs.Result(slot) = STALL_BUFFER_BUSY;
           }
           else if (full)
           {
-            if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+            if (f->watch || (_IsWatched()))
             {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                          << " Discarding grant from input " << input
@@ -2248,7 +2132,7 @@ void IQRouter::_SWAllocEvaluate()
                          << "." << (expanded_output % _output_speedup)
                          << " because all suitable output VCs for piggyback allocation are full." << endl;
             }
-            iter->second.second = reserved ? STALL_BUFFER_RESERVED : STALL_BUFFER_FULL;
+            _sw_alloc_vcs.Result(slot) = reserved ? STALL_BUFFER_RESERVED : STALL_BUFFER_FULL;
           }
         }
       }
@@ -2261,7 +2145,7 @@ void IQRouter::_SWAllocEvaluate()
 
         if (dest_buf->IsFullFor(match_vc))
         {
-          if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+          if (f->watch || (_IsWatched()))
           {
             *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                        << "  Discarding grant from input " << input
@@ -2270,7 +2154,7 @@ void IQRouter::_SWAllocEvaluate()
                        << "." << (expanded_output % _output_speedup)
                        << " due to lack of credit." << endl;
           }
-          iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+          _sw_alloc_vcs.Result(slot) = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
         }
       }
     }
@@ -2279,21 +2163,13 @@ void IQRouter::_SWAllocEvaluate()
 
 void IQRouter::_SWAllocUpdate()
 {
-  while (!_sw_alloc_vcs.empty())
+  for (int slot = _sw_alloc_vcs.FirstReady(GetSimTime()); slot >= 0; slot = _sw_alloc_vcs.FirstReady(GetSimTime()))
   {
+    assert(GetSimTime() == _sw_alloc_vcs.ReadyTime());
 
-    pair<int, pair<pair<int, int>, int> > const &item = _sw_alloc_vcs.front();
-
-    int const time = item.first;
-    if ((time < 0) || (GetSimTime() < time))
-    {
-      break;
-    }
-    assert(GetSimTime() == time);
-
-    int const input = item.second.first.first;
+    int const input = _sw_alloc_vcs.Input(slot);
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.first.second;
+    int const vc = _sw_alloc_vcs.VC(slot);
     assert((vc >= 0) && (vc < _vcs));
 
     Buffer *const cur_buf = _buf[input];
@@ -2305,7 +2181,7 @@ void IQRouter::_SWAllocUpdate()
     assert(f);
     assert(f->vc == vc);
 
-    if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    if (f->watch || (_IsWatched()))
     {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                  << " completed switch allocation for VC " << vc
@@ -2314,7 +2190,7 @@ void IQRouter::_SWAllocUpdate()
                  << ")." << endl;
     }
 
-    int const expanded_output = item.second.second;
+    int const expanded_output = _sw_alloc_vcs.Result(slot);
 
     if (expanded_output >= 0)
     {
@@ -2345,11 +2221,11 @@ void IQRouter::_SWAllocUpdate()
         int match_prio = numeric_limits<int>::min();
 
         const OutputSet *route_set = cur_buf->GetRouteSet(vc);
-        set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+        OutputSet const & setlist = route_set->GetSet();
 
         assert(!_noq || (setlist.size() == 1));
 
-        for (set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+        for (OutputSet::const_iterator iset = setlist.begin();
              iset != setlist.end();
              ++iset)
         {
@@ -2403,7 +2279,7 @@ void IQRouter::_SWAllocUpdate()
         }
         assert(match_vc >= 0);
 
-        if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+        if (f->watch || (_IsWatched()))
         {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                      << "  Allocating VC " << match_vc
@@ -2426,7 +2302,7 @@ void IQRouter::_SWAllocUpdate()
       }
       assert((match_vc >= 0) && (match_vc < _vcs));
 
-      if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+      if (f->watch || (_IsWatched()))
       {
         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                    << "  Scheduling switch connection from input " << input
@@ -2482,7 +2358,7 @@ void IQRouter::_SWAllocUpdate()
         {
           if (_noq)
           {
-            if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+            if (f->watch || (_IsWatched()))
             {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                          << " Updating lookahead routing information for flit " << f->id
@@ -2502,7 +2378,7 @@ void IQRouter::_SWAllocUpdate()
           }
           else
           {
-            if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+            if (f->watch || (_IsWatched()))
             {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                          << "Updating lookahead routing information for flit " << f->id
@@ -2532,7 +2408,7 @@ void IQRouter::_SWAllocUpdate()
       {
         _out_queue_credits.insert(make_pair(input, Credit::New()));
       }
-      _out_queue_credits.find(input)->second->vc.insert(vc);
+      _out_queue_credits.find(input)->second->AddVC(vc);
 
       if (cur_buf->Empty(vc))
       {
@@ -2553,8 +2429,8 @@ void IQRouter::_SWAllocUpdate()
           {
               cur_buf->SetState(vc, VC::routing);
               if (nf->mflag) {
-                  _route_vcs_multi.push_back(make_pair(-1, item.second.first));
-                  if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+                  _route_vcs_multi.Push(input, vc);
+                  if (f->watch || (_IsWatched()))
                   {
                       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " << GetID()
                           << "  flit " << nf->id
@@ -2564,8 +2440,8 @@ void IQRouter::_SWAllocUpdate()
 
               else
               {
-                  _route_vcs.push_back(make_pair(-1, item.second.first));
-                  if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+                  _route_vcs.Push(input, vc);
+                  if (f->watch || (_IsWatched()))
                   {
                       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " << GetID()
                           << "  flit " << nf->id
@@ -2587,13 +2463,11 @@ void IQRouter::_SWAllocUpdate()
             cur_buf->SetState(vc, VC::vc_alloc);
             if (_speculative)
             {
-              _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                                                              -1)));
+              _sw_alloc_vcs.Push(input, vc);
             }
             if (_vc_allocator)
             {
-              _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                                                              -1)));
+              _vc_alloc_vcs.Push(input, vc);
             }
             if (_noq)
             {
@@ -2605,7 +2479,7 @@ void IQRouter::_SWAllocUpdate()
         {
           if (_hold_switch_for_packet)
           {
-            if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+            if (f->watch || (_IsWatched()))
             {
               *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                          << "Setting up switch hold for VC " << vc
@@ -2618,20 +2492,18 @@ void IQRouter::_SWAllocUpdate()
             _switch_hold_vc[expanded_input] = vc;
             _switch_hold_in[expanded_input] = expanded_output;
             _switch_hold_out[expanded_output] = expanded_input;
-            _sw_hold_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                                                           -1)));
+            _sw_hold_vcs.Push(input, vc);
           }
           else
           {   //Body flit and tail flit gets pushed back here
-            _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                                                            -1)));
+            _sw_alloc_vcs.Push(input, vc);
           }
         }
       }
     }
     else
     {
-      if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+      if (f->watch || (_IsWatched()))
       {
         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                    << "  No output port allocated." << endl;
@@ -2666,18 +2538,18 @@ void IQRouter::_SWAllocUpdate()
       }
 #endif
 
-      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+      _sw_alloc_vcs.Push(input, vc);
     }
-    _sw_alloc_vcs.pop_front();
+    _sw_alloc_vcs.Pop();
   }
 }
 
-void IQRouter::addFlitMCastEntry(int dest, int outport, int input , int vc, int wflag)
+void IQRouter::addFlitMCastEntry(const NodeSet & dests, int outport, int input , int vc, int wflag)
 {
 
   Buffer * cur_buf = _buf[input];
   assert(!cur_buf->Empty(vc));
-  cur_buf->addFlitMCastEntry(vc, dest, outport, wflag);
+  cur_buf->addFlitMCastEntry(vc, dests, outport, wflag);
     
 }
 
@@ -2689,21 +2561,12 @@ void IQRouter::_RouteEvaluateMulti()
 {
   assert(_routing_delay);
 
-  for (deque<pair<int, pair<int, int> > >::iterator iter = _route_vcs_multi.begin();
-       iter != _route_vcs_multi.end();
-       ++iter)
+  for (int slot = _route_vcs_multi.Launch(GetSimTime() + _routing_delay - 1); slot >= 0; slot = _route_vcs_multi.NextReady(slot))
   {
 
-    int const time = iter->first;
-    if (time >= 0)
-    {
-      break;
-    }
-    iter->first = GetSimTime() + _routing_delay - 1;
-
-    int const input = iter->second.first;
+    int const input = _route_vcs_multi.Input(slot);
     assert((input >= 0) && (input < _inputs));
-    int const vc = iter->second.second;
+    int const vc = _route_vcs_multi.VC(slot);
     assert((vc >= 0) && (vc < _vcs));
 
     Buffer const *const cur_buf = _buf[input];
@@ -2715,7 +2578,7 @@ void IQRouter::_RouteEvaluateMulti()
     assert(f->vc == vc);
     assert(f->head);
 
-    if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    if (f->watch || (_IsWatched()))
     {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                  << " mcast Beginning routing for VC " << vc
@@ -2730,21 +2593,13 @@ void IQRouter::_RouteUpdateMulti()
 {
   assert(_routing_delay);
 
-  while (!_route_vcs_multi.empty())
+  for (int slot = _route_vcs_multi.FirstReady(GetSimTime()); slot >= 0; slot = _route_vcs_multi.FirstReady(GetSimTime()))
   {
+    assert(GetSimTime() == _route_vcs_multi.ReadyTime());
 
-    pair<int, pair<int, int> > const &item = _route_vcs_multi.front();
-
-    int const time = item.first;
-    if ((time < 0) || (GetSimTime() < time))
-    {
-      break;
-    }
-    assert(GetSimTime() == time);
-
-    int const input = item.second.first;
+    int const input = _route_vcs_multi.Input(slot);
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.second;
+    int const vc = _route_vcs_multi.VC(slot);
     assert((vc >= 0) && (vc < _vcs));
 
     Buffer *const cur_buf = _buf[input];
@@ -2756,7 +2611,7 @@ void IQRouter::_RouteUpdateMulti()
     assert(f->vc == vc);
     assert(f->head);
 
-    if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    if (f->watch || (_IsWatched()))
     {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                  << " mcast Completed routing for VC " << vc
@@ -2769,19 +2624,18 @@ void IQRouter::_RouteUpdateMulti()
     cur_buf->SetState(vc, VC::vc_alloc);
     // if (_speculative)
     // {
-    //   _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second, -1)));
+    //   _sw_alloc_vcs.Push(input, vc);
     // }
     if (_vc_allocator)
     {
       // push multiple entries here for each outut port
-      map<int, pair<vector<int>, vector<int> > > mcast_table = cur_buf->GetMcastTable(vc);
       //for(map<int, pair<vector<int>, vector<int> > >::iterator itr = mcast_table.begin();itr != mcast_table.end(); itr++)
       //{
-        _vc_alloc_vcs_multi.push_back(make_pair(-1, make_pair(item.second, make_pair(false,-1))));
+        _vc_alloc_vcs_multi.push_back(make_pair(-1, make_pair(make_pair(input, vc), make_pair(false,-1))));
       //}
     }
     // NOTE: No need to handle NOQ here, as it requires lookahead routing!
-    _route_vcs_multi.pop_front();
+    _route_vcs_multi.Pop();
   }
 }
 
@@ -2823,7 +2677,7 @@ void IQRouter::_VCAllocEvaluateMulti()
     assert(f->vc == vc);
     assert(f->head);
 
-    if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    if (f->watch || (_IsWatched()))
     {
       // cout<<"TIme is "<<time<<endl;
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
@@ -2837,7 +2691,7 @@ void IQRouter::_VCAllocEvaluateMulti()
     // assert(route_set);
 
     int const out_priority = cur_buf->GetPriority(vc);
-    // set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+    // OutputSet const & setlist = route_set->GetSet();
 
     bool elig = false;
     bool cred = false;
@@ -2845,7 +2699,7 @@ void IQRouter::_VCAllocEvaluateMulti()
 
     // assert(!_noq || (setlist.size() == 1));
 
-    // for (set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+    // for (OutputSet::const_iterator iset = setlist.begin();
     //      iset != setlist.end();
     //      ++iset)
     // {
@@ -2853,9 +2707,10 @@ void IQRouter::_VCAllocEvaluateMulti()
     //int const out_port_number = iter->second.second.first;
     //assert((out_port >= 0) && (out_port < _outputs));
     int vc_acquired =0;
-    map<int,int> empty_vc;
-    for (auto& x : cur_buf->GetMcastTable(vc)) {
-        BufferState const* const dest_buf = _next_buf[x.first];
+    McastTable const & mcast_table = cur_buf->GetMcastTable(vc);
+    vector<int> & empty_vc = _mcast_empty_vc;
+    for (int port = mcast_table.FirstPort(); port >= 0; port = mcast_table.NextPort(port)) {
+        BufferState const* const dest_buf = _next_buf[port];
 
         int vc_start;
         int vc_end;
@@ -2895,14 +2750,14 @@ void IQRouter::_VCAllocEvaluateMulti()
             if (!((dest_buf->AvailableFor(out_vc) - f->flits_num >= 0) && dest_buf->IsAvailableFor(out_vc)))
             {
 
-                if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+                if (f->watch || (_IsWatched()))
                 {
                     int const use_input_and_vc = dest_buf->UsedBy(out_vc);
                     int const use_input = use_input_and_vc / _vcs;
                     int const use_vc = use_input_and_vc % _vcs;
                     *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " << GetID()
                         << " mcast VC " << out_vc
-                        << " at output " << x.first
+                        << " at output " << port
                         << " is in use by VC " << use_vc
                         << " at input " << use_input;
                     //Flit* cf = dest_buf[use_input]->FrontFlit(use_vc);
@@ -2924,10 +2779,10 @@ void IQRouter::_VCAllocEvaluateMulti()
                 elig = true;
                 if (_vc_busy_when_full && dest_buf->IsFullFor(out_vc))
                 {
-                    if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+                    if (f->watch || (_IsWatched()))
                         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " << GetID()
                         << "  VC " << out_vc
-                        << " at output " << x.first
+                        << " at output " << port
                         << " is full. " << "last pid = " << dest_buf->_last_pid[out_vc] << "last fid = " << dest_buf->_last_id[out_vc] << endl;
                     dest_buf->Display(*gWatchOut);
                     reserved |= !dest_buf->IsFull();
@@ -2943,11 +2798,11 @@ void IQRouter::_VCAllocEvaluateMulti()
                     // iter->first = GetSimTime() + _vc_alloc_delay - 1;
                     cred = true;
 
-                    if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+                    if (f->watch || (_IsWatched()))
                     {
                         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " << GetID()
                             << " mcast Requesting VC " << out_vc
-                            << " at output " << x.first
+                            << " at output " << port
                             << " (in_pri: " << in_priority
                             << ", out_pri: " << out_priority
                             << ")." << endl;
@@ -2955,26 +2810,26 @@ void IQRouter::_VCAllocEvaluateMulti()
 
                     }
                     vc_acquired += 1;
-                    empty_vc[x.first]=out_vc;
+                    empty_vc[port]=out_vc;
                     break;
                 }
             }
         }
     }
-    if (vc_acquired == cur_buf->GetMcastTable(vc).size()) {
+    if (vc_acquired == mcast_table.NumPorts()) {
         // iter->second.second.second = out_port * _vcs + out_vc;
-        for (auto& x : cur_buf->GetMcastTable(vc)) {
-            BufferState* const dest_buf = _next_buf[x.first];
-            assert(dest_buf->IsAvailableFor(empty_vc[x.first]));
+        for (int port = mcast_table.FirstPort(); port >= 0; port = mcast_table.NextPort(port)) {
+            BufferState* const dest_buf = _next_buf[port];
+            assert(dest_buf->IsAvailableFor(empty_vc[port]));
             Flit* cf = _buf[input]->FrontFlit(vc);
-            dest_buf->TakeBuffer(empty_vc[x.first], input * _vcs + vc);
+            dest_buf->TakeBuffer(empty_vc[port], input * _vcs + vc);
 
-            cur_buf->PushMOutputandVC(vc, x.first * _vcs + empty_vc[x.first]);
-            if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+            cur_buf->PushMOutputandVC(vc, port * _vcs + empty_vc[port]);
+            if (f->watch || (_IsWatched()))
             {
                 *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " << GetID()
-                    << " mcast Assigning VC " << empty_vc[x.first]
-                    << " at output " << x.first
+                    << " mcast Assigning VC " << empty_vc[port]
+                    << " at output " << port
                     << " to VC " << vc
                     << " at input " << input
                     << "." << endl;
@@ -3050,7 +2905,7 @@ void IQRouter::_VCAllocEvaluateMulti()
     assert(f->head);
 
     int const input_and_vc = _vc_shuffle_requests ? (vc * _inputs + input) : (input * _vcs + vc);
-    vector <int > Outpairs = cur_buf->GetMulticastOutpair(vc);
+    vector<int> const & Outpairs = cur_buf->GetMulticastOutpair(vc);
     int output_and_vc = -1;
     for(int i = 0 ; i < Outpairs.size() ; i++)
       if ( Outpairs[i]/_vcs == iter->second.second.first ) {
@@ -3067,7 +2922,7 @@ void IQRouter::_VCAllocEvaluateMulti()
       int const match_vc = output_and_vc % _vcs;
       assert((match_vc >= 0) && (match_vc < _vcs));
 
-      if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+      if (f->watch || (_IsWatched()))
       {
         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                    << " mcast Assigning VC " << match_vc
@@ -3083,7 +2938,7 @@ void IQRouter::_VCAllocEvaluateMulti()
     else
     {
 
-      if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+      if (f->watch || (_IsWatched()))
       {
         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                    << " mcast VC allocation failed for VC " << vc
@@ -3142,7 +2997,7 @@ void IQRouter::_VCAllocEvaluateMulti()
 
   //     if (!dest_buf->IsAvailableFor(match_vc))
   //     {
-  //       if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+  //       if (f->watch || (_IsWatched()))
   //       {
   //         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
   //                    << "  Discarding previously generated grant for VC " << vc
@@ -3155,7 +3010,7 @@ void IQRouter::_VCAllocEvaluateMulti()
   //     }
   //     else if (_vc_busy_when_full && dest_buf->IsFullFor(match_vc))
   //     {
-  //       if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+  //       if (f->watch || (_IsWatched()))
   //       {
   //         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
   //                    << "  Discarding previously generated grant for VC " << vc
@@ -3198,7 +3053,7 @@ void IQRouter::_VCAllocUpdateMulti()
     Buffer *const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
 
-    if(cur_buf->GetMulticastOutpair(vc).size() != cur_buf->GetMcastTable(vc).size())
+    if((int)cur_buf->GetMulticastOutpair(vc).size() != cur_buf->GetMcastTable(vc).NumPorts())
       assert(cur_buf->GetState(vc) == VC::vc_alloc);
 
     Flit const *const f = cur_buf->FrontFlit(vc);
@@ -3206,7 +3061,7 @@ void IQRouter::_VCAllocUpdateMulti()
     assert(f->vc == vc);
     assert(f->head);
 
-    if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    if (f->watch || (_IsWatched()))
     {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                  << " mcast Completed VC allocation for VC " << vc
@@ -3224,7 +3079,7 @@ void IQRouter::_VCAllocUpdateMulti()
       int const match_vc = output_and_vc % _vcs;
       assert((match_vc >= 0) && (match_vc < _vcs));
 
-      if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+      if (f->watch || (_IsWatched()))
       {
         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                    << " mcast Acquiring assigned VC " << match_vc
@@ -3233,12 +3088,12 @@ void IQRouter::_VCAllocUpdateMulti()
       }*/
 
       //BufferState *const dest_buf = _next_buf[match_output];
-        assert(cur_buf->GetMulticastOutpair(vc).size() == cur_buf->GetMcastTable(vc).size());
+        assert((int)cur_buf->GetMulticastOutpair(vc).size() == cur_buf->GetMcastTable(vc).NumPorts());
             cur_buf->SetState(vc, VC::active);
 //            if(finish_invc.count(item.second.first.first * _vcs + item.second.first.second)==0)
             for (int i = 0; i < cur_buf->GetMulticastOutpair(vc).size(); i++) {
                 _sw_alloc_vcs_multi.push_back(make_pair(-1, make_pair(make_pair(item.second.first, cur_buf->GetMulticastOutpair(vc)[i]), -1)));
-                if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+                if (f->watch || (_IsWatched()))
                 {
                     *gWatchOut << " push into switch alloc vc_alloc " << f->id << " Switch allocation to do is " << _sw_alloc_vcs_multi.size() << endl;
                 }
@@ -3253,7 +3108,7 @@ void IQRouter::_VCAllocUpdateMulti()
     }
     else
     {
-      if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+      if (f->watch || (_IsWatched()))
       {
         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                    << "  No output VC allocated." << endl;
@@ -3302,7 +3157,7 @@ bool IQRouter::_SWAllocAddReqMulti(int input, int vc, int output)
   Buffer *const cur_buf = _buf[input];
   assert(!cur_buf->Empty(vc));
   
-  if(cur_buf->GetMCastCount(vc) == cur_buf->GetMcastTable(vc).size())
+  if(cur_buf->GetMCastCount(vc) == cur_buf->GetMcastTable(vc).NumPorts())
   {
     assert((cur_buf->GetState(vc) == VC::active) ||
           (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
@@ -3339,7 +3194,7 @@ bool IQRouter::_SWAllocAddReqMulti(int input, int vc, int output)
       if (RoundRobinArbiter::Supersedes(vc, prio, req.label, req.in_pri,
                                         _sw_rr_offset[expanded_input], _vcs)) //Only body and tail
       {
-        if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+        if (f->watch || (_IsWatched()))
         {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                      << "  Replacing earlier request from VC " << req.label
@@ -3355,7 +3210,7 @@ bool IQRouter::_SWAllocAddReqMulti(int input, int vc, int output)
         return true;
       }
 
-      if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+      if (f->watch || (_IsWatched()))
       {
         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                    << "  Output " << output
@@ -3368,7 +3223,7 @@ bool IQRouter::_SWAllocAddReqMulti(int input, int vc, int output)
       return false;
     }
 
-    if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    if (f->watch || (_IsWatched()))
     {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                  << "  Requesting output " << output
@@ -3381,7 +3236,7 @@ bool IQRouter::_SWAllocAddReqMulti(int input, int vc, int output)
     return true;
   }
 
-  if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+  if (f->watch || (_IsWatched()))
   {
     *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                << "  Ignoring output " << output
@@ -3433,7 +3288,7 @@ void IQRouter::_SWAllocEvaluateMulti()
 
     Buffer *const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
-    if(cur_buf->GetMCastCount(vc) == cur_buf->GetMcastTable(vc).size())
+    if(cur_buf->GetMCastCount(vc) == cur_buf->GetMcastTable(vc).NumPorts())
     {
       assert((cur_buf->GetState(vc) == VC::active) ||
             (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
@@ -3444,7 +3299,7 @@ void IQRouter::_SWAllocEvaluateMulti()
     assert(f);
     assert(f->vc == vc);
 
-    if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    if (f->watch || (_IsWatched()))
     {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                  << " mcast Beginning switch allocation for VC " << vc
@@ -3465,7 +3320,7 @@ void IQRouter::_SWAllocEvaluateMulti()
 
       if (dest_buf->IsFullFor(dest_vc) || (_output_buffer_size != -1 && _output_buffer[dest_output].size() >= (size_t)(_output_buffer_size)))
       {
-        if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+        if (f->watch || (_IsWatched()))
         {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                      << " mcast VC " << dest_vc
@@ -3496,11 +3351,11 @@ void IQRouter::_SWAllocEvaluateMulti()
     // OutputSet const *const route_set = cur_buf->GetRouteSet(vc);
     // assert(route_set);
 
-    // set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+    // OutputSet const & setlist = route_set->GetSet();
 
     // assert(!_noq || (setlist.size() == 1));
 
-    // for (set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+    // for (OutputSet::const_iterator iset = setlist.begin();
     //      iset != setlist.end();
     //      ++iset)
     // {
@@ -3558,7 +3413,7 @@ void IQRouter::_SWAllocEvaluateMulti()
 
     //   if (_spec_check_elig && !elig)
     //   {
-    //     if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    //     if (f->watch || (_IsWatched()))
     //     {
     //       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
     //                  << "  Output " << dest_output
@@ -3568,7 +3423,7 @@ void IQRouter::_SWAllocEvaluateMulti()
     //   }
     //   else if (_spec_check_cred && !cred)
     //   {
-    //     if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    //     if (f->watch || (_IsWatched()))
     //     {
     //       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
     //                  << "  All suitable VCs at output " << dest_output
@@ -3609,7 +3464,17 @@ void IQRouter::_SWAllocEvaluateMulti()
   //     _spec_sw_allocator->PrintGrants(gWatchOut);
   //   }
   // }
+}
 
+
+// Multicast requests were placed in the same switch allocators as the
+// unicast ones and competed in the same Allocate(). A copy is granted its
+// output only if its request survived, and the output was neither assigned
+// to another input nor already given to another multicast copy this cycle.
+// Multicast VCs do not need the input-side grant, so a flit can still fan
+// out to several outputs at once.
+void IQRouter::_SWAllocGrantMulti()
+{
   for (deque<pair<int, pair<pair<pair<int, int>, int >,int> > >::iterator iter = _sw_alloc_vcs_multi.begin();
        iter != _sw_alloc_vcs_multi.end();
        ++iter)
@@ -3636,7 +3501,7 @@ void IQRouter::_SWAllocEvaluateMulti()
 
     Buffer *const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
-    if(cur_buf->GetMCastCount(vc) == cur_buf->GetMcastTable(vc).size())
+    if(cur_buf->GetMCastCount(vc) == cur_buf->GetMcastTable(vc).NumPorts())
     {
       assert((cur_buf->GetState(vc) == VC::active) ||
             (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
@@ -3648,17 +3513,25 @@ void IQRouter::_SWAllocEvaluateMulti()
 
     int const expanded_input = input * _input_speedup + vc % _input_speedup;
 
-    // int expanded_output = _sw_allocator->OutputAssigned(expanded_input);
-    int expanded_output = (iter->second.first.second / _vcs) * _output_speedup;
+    int const expanded_output = (iter->second.first.second / _vcs) * _output_speedup + input % _output_speedup;
 
+    Allocator const *const allocator =
+        (_spec_sw_allocator && (cur_buf->GetState(vc) == VC::vc_alloc)) ? _spec_sw_allocator : _sw_allocator;
 
-    if (expanded_output >= 0)
+    int const granted_in = _sw_allocator->InputAssigned(expanded_output);
+    int const spec_granted_in = _spec_sw_allocator ? _spec_sw_allocator->InputAssigned(expanded_output) : -1;
+
+    bool const granted = (allocator->ReadRequest(expanded_input, expanded_output) == vc) &&
+                         ((granted_in < 0) || (granted_in == expanded_input)) &&
+                         ((spec_granted_in < 0) || (spec_granted_in == expanded_input)) &&
+                         (_mcast_sw_claim[expanded_output] != GetSimTime());
+
+    if (granted)
     {
       assert((expanded_output % _output_speedup) == (input % _output_speedup));
-      // int const granted_vc = _sw_allocator->ReadRequest(expanded_input, expanded_output);
-      // if (granted_vc == vc)
+      _mcast_sw_claim[expanded_output] = GetSimTime();
       // {
-        if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+        if (f->watch || (_IsWatched()))
         {
           *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                      << " mcast Assigning output " << (expanded_output / _output_speedup)
@@ -3673,7 +3546,7 @@ void IQRouter::_SWAllocEvaluateMulti()
       // }
       // else
       // {
-      //   if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+      //   if (f->watch || (_IsWatched()))
       //   {
       //     *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
       //                << "Switch allocation failed for VC " << vc
@@ -3692,7 +3565,7 @@ void IQRouter::_SWAllocEvaluateMulti()
     //     if (_spec_mask_by_reqs &&
     //         _sw_allocator->OutputHasRequests(expanded_output))
     //     {
-    //       if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    //       if (f->watch || (_IsWatched()))
     //       {
     //         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
     //                    << " Discarding speculative grant for VC " << vc
@@ -3707,7 +3580,7 @@ void IQRouter::_SWAllocEvaluateMulti()
     //     else if (!_spec_mask_by_reqs &&
     //              (_sw_allocator->InputAssigned(expanded_output) >= 0))
     //     {
-    //       if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    //       if (f->watch || (_IsWatched()))
     //       {
     //         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
     //                    << " Discarding speculative grant for VC " << vc
@@ -3725,7 +3598,7 @@ void IQRouter::_SWAllocEvaluateMulti()
     //                                                              expanded_output);
     //       if (granted_vc == vc)
     //       {
-    //         if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    //         if (f->watch || (_IsWatched()))
     //         {
     //           *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
     //                      << " assigning output " << (expanded_output / _output_speedup)
@@ -3740,7 +3613,7 @@ void IQRouter::_SWAllocEvaluateMulti()
     //       }
     //       else
     //       {
-    //         if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    //         if (f->watch || (_IsWatched()))
     //         {
     //           *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
     //                      << "Switch allocation failed for VC " << vc
@@ -3754,7 +3627,7 @@ void IQRouter::_SWAllocEvaluateMulti()
     //   else
     //   {
 
-    //     if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    //     if (f->watch || (_IsWatched()))
     //     {
     //       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
     //                  << "Switch allocation failed for VC " << vc
@@ -3767,7 +3640,7 @@ void IQRouter::_SWAllocEvaluateMulti()
     // }
     else
     {
-      if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+      if (f->watch || (_IsWatched()))
       {
         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                    << " mcast Switch allocation failed for VC " << vc
@@ -3828,7 +3701,7 @@ void IQRouter::_SWAllocEvaluateMulti()
   //     if ((_switch_hold_in[expanded_input] >= 0) ||
   //         (_switch_hold_out[expanded_output] >= 0))
   //     {
-  //       if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+  //       if (f->watch || (_IsWatched()))
   //       {
   //         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
   //                    << " Discarding grant from input " << input
@@ -3867,7 +3740,7 @@ void IQRouter::_SWAllocEvaluateMulti()
 
   //         if (output_and_vc < 0)
   //         {
-  //           if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+  //           if (f->watch || (_IsWatched()))
   //           {
   //             *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
   //                        << " Discarding grant from input " << input
@@ -3880,7 +3753,7 @@ void IQRouter::_SWAllocEvaluateMulti()
   //         }
   //         else if ((output_and_vc / _vcs) != output)
   //         {
-  //           if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+  //           if (f->watch || (_IsWatched()))
   //           {
   //             *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
   //                        << " Discarding grant from input " << input
@@ -3893,7 +3766,7 @@ void IQRouter::_SWAllocEvaluateMulti()
   //         }
   //         else if (dest_buf->IsFullFor((output_and_vc % _vcs)))
   //         {
-  //           if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+  //           if (f->watch || (_IsWatched()))
   //           {
   //             *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
   //                        << " Discarding grant from input " << input
@@ -3911,7 +3784,7 @@ void IQRouter::_SWAllocEvaluateMulti()
   //         OutputSet const *const route_set = cur_buf->GetRouteSet(vc);
   //         assert(route_set);
 
-  //         set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+  //         OutputSet const & setlist = route_set->GetSet();
 
   //         bool busy = true;
   //         bool full = true;
@@ -3919,7 +3792,7 @@ void IQRouter::_SWAllocEvaluateMulti()
 
   //         assert(!_noq || (setlist.size() == 1));
 
-  //         for (set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+  //         for (OutputSet::const_iterator iset = setlist.begin();
   //              iset != setlist.end();
   //              ++iset)
   //         {
@@ -3970,7 +3843,7 @@ void IQRouter::_SWAllocEvaluateMulti()
 
   //         if (busy)
   //         {
-  //           if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+  //           if (f->watch || (_IsWatched()))
   //           {
   //             *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
   //                        << " Discarding grant from input " << input
@@ -3983,7 +3856,7 @@ void IQRouter::_SWAllocEvaluateMulti()
   //         }
   //         else if (full)
   //         {
-  //           if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+  //           if (f->watch || (_IsWatched()))
   //           {
   //             *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
   //                        << " Discarding grant from input " << input
@@ -4005,7 +3878,7 @@ void IQRouter::_SWAllocEvaluateMulti()
 
   //       if (dest_buf->IsFullFor(match_vc))
   //       {
-  //         if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+  //         if (f->watch || (_IsWatched()))
   //         {
   //           *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
   //                      << "  Discarding grant from input " << input
@@ -4044,11 +3917,11 @@ void IQRouter::_SWAllocUpdateMulti()
 
         Buffer* const cur_buf = _buf[input];
         Flit* const f = cur_buf->FrontFlit(vc);
-        //if(cur_buf->GetMcastTable(vc).size()!=0 && f->mflag ==1){
-        // cout<<"GetMcastTable(vc).size "<< cur_buf->GetMcastTable(vc).size() <<endl;
+        //if(cur_buf->GetMcastTable(vc).NumPorts()!=0 && f->mflag ==1){
+        // cout<<"GetMcastTable(vc).size "<< cur_buf->GetMcastTable(vc).NumPorts() <<endl;
         assert(!cur_buf->Empty(vc));
 
-        if (cur_buf->GetMCastCount(vc) == cur_buf->GetMcastTable(vc).size())
+        if (cur_buf->GetMCastCount(vc) == cur_buf->GetMcastTable(vc).NumPorts())
         {
             assert((cur_buf->GetState(vc) == VC::active) ||
                 (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
@@ -4059,7 +3932,7 @@ void IQRouter::_SWAllocUpdateMulti()
         assert(f->mflag == 1);
         assert(f->vc == vc);
 
-        if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+        if (f->watch || (_IsWatched()))
         {
             *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                 << " mcast Completed switch allocation for VC " << vc
@@ -4093,7 +3966,7 @@ void IQRouter::_SWAllocUpdateMulti()
             // }
             assert((match_vc >= 0) && (match_vc < _vcs));
 
-            if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+            if (f->watch || (_IsWatched()))
             {
                 *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                     << " mcast Scheduling switch connection from input " << input
@@ -4103,7 +3976,7 @@ void IQRouter::_SWAllocUpdateMulti()
                     << "." << endl;
             }
             Flit* f_dup;
-            if (mcount == cur_buf->GetMcastTable(vc).size())
+            if (mcount == cur_buf->GetMcastTable(vc).NumPorts())
             {
 
                 cur_buf->RemoveFlit(vc);
@@ -4111,7 +3984,7 @@ void IQRouter::_SWAllocUpdateMulti()
                 f_dup = f;
                 f_dup = _Generate_Duplicates(f, output, false);
                 // cout<<"source router "<<f_dup->src<<" original id "<<f->id<<" f_dup id "<<f_dup->id<<" output "<<output<<" rid "<<GetID()<<endl;
-                if (f_dup->watch || (_routers_to_watch.count(GetID()) > 0)) {
+                if (f_dup->watch || (_IsWatched())) {
                     *gWatchOut << GetSimTime() << " | "
                         << " Egress original flit " << f_dup->id
                         << " (packet " << f_dup->pid << " mflag = " << f_dup->mflag
@@ -4123,7 +3996,7 @@ void IQRouter::_SWAllocUpdateMulti()
             {
                 f_dup = _Generate_Duplicates(f, output, true);
                 // cout<<"source router "<<f_dup->src<<" original id "<<f->id<<" f_dup id "<<f_dup->id<<" output "<<output<<" rid "<<GetID()<<endl;
-                if (f_dup->watch || (_routers_to_watch.count(GetID()) > 0)) {
+                if (f_dup->watch || (_IsWatched())) {
                     *gWatchOut << GetSimTime() << " | "
                         << " Egress Duplicate flit " << f_dup->id
                         << " (packet " << f_dup->pid << " mflag = " << f_dup->mflag
@@ -4131,21 +4004,21 @@ void IQRouter::_SWAllocUpdateMulti()
                         << "." << endl;
                 }
             }
-            f_dup->mdest = cur_buf->GetMcastTable(vc)[output];
+            f_dup->MutableMdest() = cur_buf->GetMcastTable(vc).Dests(output);
             /*
-            if (f_dup->mdest.first.size() == 1 && f_dup->mdest.second.size() == 0) {
-                f_dup->dest = f_dup->mdest.first[0];
+            if (f_dup->GetMdest().first.Size() == 1 && f_dup->GetMdest().second.Empty()) {
+                f_dup->dest = f_dup->GetMdest().first.First();
                 f_dup->mflag = false;
             }*/
-            if (f_dup->head && f_dup->watch || (_routers_to_watch.count(GetID()) > 0))
+            if (f_dup->head && f_dup->watch || (_IsWatched()))
             {
 
 
                 *gWatchOut << " Dup_Pid " << f_dup->pid << " Destinations are: ";
-                for (int i = 0; i < f_dup->mdest.first.size(); i++) {
-                    *gWatchOut << f_dup->mdest.first[i] << " " << endl;
+                for (int d = f_dup->GetMdest().first.First(); d >= 0; d = f_dup->GetMdest().first.Next(d)) {
+                    *gWatchOut << d << " " << endl;
                 }
-                *gWatchOut << "num dests " << f_dup->mdest.first.size() << " simtime " << GetSimTime() << " source " << f_dup->src << endl;
+                *gWatchOut << "num dests " << f_dup->GetMdest().first.Size() << " simtime " << GetSimTime() << " source " << f_dup->src << endl;
             }
 
 #ifdef TRACK_FLOWS
@@ -4191,7 +4064,7 @@ void IQRouter::_SWAllocUpdateMulti()
             //   {
             //     if (_noq)
             //     {
-            //       if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+            //       if (f->watch || (_IsWatched()))
             //       {
             //         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
             //                    << "Updating lookahead routing information for flit " << f->id
@@ -4211,7 +4084,7 @@ void IQRouter::_SWAllocUpdateMulti()
             //     }
             //     else
             //     {
-            //       if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+            //       if (f->watch || (_IsWatched()))
             //       {
             //         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
             //                    << "Updating lookahead routing information for flit " << f->id
@@ -4240,29 +4113,29 @@ void IQRouter::_SWAllocUpdateMulti()
             // }
             _crossbar_flits.push_back(make_pair(-1, make_pair(f_dup, make_pair(expanded_input, expanded_output))));
 
-            if (mcount == cur_buf->GetMcastTable(vc).size())
+            if (mcount == cur_buf->GetMcastTable(vc).NumPorts())
             {
                 if (_out_queue_credits.count(input) == 0)
                 {
                     _out_queue_credits.insert(make_pair(input, Credit::New()));
                 }
-                _out_queue_credits.find(input)->second->vc.insert(vc);
+                _out_queue_credits.find(input)->second->AddVC(vc);
             }
             if (cur_buf->Empty(vc))
             {
                 cur_buf->SetMCastCount(vc, 0);
-                assert(mcount == cur_buf->GetMcastTable(vc).size());
+                assert(mcount == cur_buf->GetMcastTable(vc).NumPorts());
                 if (f_dup->tail)
                 {
                     // cout<<" comes here right"<<endl;
-                    if (mcount == cur_buf->GetMcastTable(vc).size())
+                    if (mcount == cur_buf->GetMcastTable(vc).NumPorts())
                     {
                         cur_buf->SetState(vc, VC::idle);
                     }
 
                     cur_buf->EraseMcastTable(vc);
                     cur_buf->EraseOutpair(vc);
-                    if (f_dup->watch || (_routers_to_watch.count(GetID()) > 0))
+                    if (f_dup->watch || (_IsWatched()))
                     {
                         *gWatchOut << " mcast all output of pid= " << f_dup->pid << " is acquired, fid= " <<
                             f_dup->id << " turn to idle = "
@@ -4276,22 +4149,22 @@ void IQRouter::_SWAllocUpdateMulti()
                 assert(nf);
                 assert(nf->vc == vc);
                 if (f_dup->tail) {
-                    if (mcount == cur_buf->GetMcastTable(vc).size()) {
+                    if (mcount == cur_buf->GetMcastTable(vc).NumPorts()) {
                         assert(nf->head);
                         if (_routing_delay)
                         {
                             cur_buf->SetState(vc, VC::routing);
                             if (nf->mflag) {
-                                _route_vcs_multi.push_back(make_pair(-1, item.second.first.first));
+                                _route_vcs_multi.Push(input, vc);
                             }
                             else
                             {
-                                _route_vcs.push_back(make_pair(-1, item.second.first.first));
+                                _route_vcs.Push(input, vc);
                             }
                             cur_buf->EraseMcastTable(vc);
                             cur_buf->EraseOutpair(vc);
                             cur_buf->SetMCastCount(vc, 0);
-                            if (f_dup->watch || (_routers_to_watch.count(GetID()) > 0))
+                            if (f_dup->watch || (_IsWatched()))
                             {
                                 *gWatchOut << " mcast all output is acquired pid= " << f_dup->pid << " fid= " <<
                                     f_dup->id << " turn to routing for pid = " << nf->pid << " fid = " << nf->id
@@ -4299,13 +4172,13 @@ void IQRouter::_SWAllocUpdateMulti()
                             }
                         }
                     }
-                    else if (mcount < cur_buf->GetMcastTable(vc).size()) {
+                    else if (mcount < cur_buf->GetMcastTable(vc).NumPorts()) {
                         /*
                         _sw_alloc_vcs_multi.push_back(make_pair(-1, make_pair(item.second.first,
                             -1)));*/
-                        if (f_dup->watch || (_routers_to_watch.count(GetID()) > 0))
+                        if (f_dup->watch || (_IsWatched()))
                         {
-                            *gWatchOut << " mcast "<< cur_buf->GetMcastTable(vc).size() - mcount <<" output of pid = " << f_dup->pid << " is not acquired, fid = " 
+                            *gWatchOut << " mcast "<< cur_buf->GetMcastTable(vc).NumPorts() - mcount <<" output of pid = " << f_dup->pid << " is not acquired, fid = " 
                                 << f_dup->id << " packet_size = "<<f_dup->flits_num << " Switch allocation to do is " << _sw_alloc_vcs_multi.size() << endl;
                         }
                     }
@@ -4313,28 +4186,28 @@ void IQRouter::_SWAllocUpdateMulti()
                 }
                 else if (!f_dup->tail) {
                     
-                    if (mcount == cur_buf->GetMcastTable(vc).size()) {
+                    if (mcount == cur_buf->GetMcastTable(vc).NumPorts()) {
                         
-                        vector<int> outputandvc = cur_buf->GetMulticastOutpair(vc);
+                        vector<int> const & outputandvc = cur_buf->GetMulticastOutpair(vc);
                         // cout<<" my size "<<outputandvc.size()<<endl;
                         for (int i = 0; i < outputandvc.size(); i++)
                         {
                             _sw_alloc_vcs_multi.push_back(make_pair(-1, make_pair(make_pair(item.second.first.first, outputandvc[i]), -1)));
                         }
                         cur_buf->SetMCastCount(vc, 0);
-                        if (f_dup->watch || (_routers_to_watch.count(GetID()) > 0))
+                        if (f_dup->watch || (_IsWatched()))
                         {
                             *gWatchOut << " mcast all output is acquired pid=" << f_dup->pid << " fid= " << f_dup->id
                                 << " packet_size = " << f_dup->flits_num << " Switch allocation to do is " << _sw_alloc_vcs_multi.size() << endl;
                         }
                     }
-                    else if (mcount < cur_buf->GetMcastTable(vc).size()) {
+                    else if (mcount < cur_buf->GetMcastTable(vc).NumPorts()) {
                         /*
                         _sw_alloc_vcs_multi.push_back(make_pair(-1, make_pair(item.second.first,
                             -1)));*/
-                        if (f_dup->watch || (_routers_to_watch.count(GetID()) > 0))
+                        if (f_dup->watch || (_IsWatched()))
                         {
-                            *gWatchOut << " mcast " << cur_buf->GetMcastTable(vc).size() - mcount << " output of pid = " << f_dup->pid << " is not acquired, fid = "
+                            *gWatchOut << " mcast " << cur_buf->GetMcastTable(vc).NumPorts() - mcount << " output of pid = " << f_dup->pid << " is not acquired, fid = "
                                 << f_dup->id << " packet_size = " << f_dup->flits_num << " Switch allocation to do is " << _sw_alloc_vcs_multi.size() << endl;
                         }
                     }
@@ -4344,7 +4217,7 @@ void IQRouter::_SWAllocUpdateMulti()
                 /*
                 else
                 {
-                    if (nf->watch || (_routers_to_watch.count(GetID()) > 0))
+                    if (nf->watch || (_IsWatched()))
                     {
                         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                             << "Using precomputed lookahead routing information for VC " << vc
@@ -4374,11 +4247,11 @@ void IQRouter::_SWAllocUpdateMulti()
                 */
             }
             /*
-            else if (!cur_buf->Empty(vc) && mcount < cur_buf->GetMcastTable(vc).size()) //Body flits
+            else if (!cur_buf->Empty(vc) && mcount < cur_buf->GetMcastTable(vc).NumPorts()) //Body flits
             {
               if (_hold_switch_for_packet)
               {
-                if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+                if (f->watch || (_IsWatched()))
                 {
                   *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                              << "Setting up switch hold for VC " << vc
@@ -4391,25 +4264,24 @@ void IQRouter::_SWAllocUpdateMulti()
                 _switch_hold_vc[expanded_input] = vc;
                 _switch_hold_in[expanded_input] = expanded_output;
                 _switch_hold_out[expanded_output] = expanded_input;
-                _sw_hold_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-                                                               -1)));
+                _sw_hold_vcs.Push(input, vc);
               }
               //Body flit and tail flit gets pushed back here
                 _sw_alloc_vcs_multi.push_back(make_pair(-1, make_pair(item.second.first,
                     -1)));
             }
 
-            if (mcount == cur_buf->GetMcastTable(vc).size())
+            if (mcount == cur_buf->GetMcastTable(vc).NumPorts())
             {
                 // cout<<"Im pushing here "<<f->id<<endl;
                 cur_buf->SetMCastCount(vc, 0);
-                vector<int> outputandvc = cur_buf->GetMulticastOutpair(vc);
+                vector<int> const & outputandvc = cur_buf->GetMulticastOutpair(vc);
                 // cout<<" my size "<<outputandvc.size()<<endl;
                 for (int i = 0; i < outputandvc.size(); i++)
                 {
                     _sw_alloc_vcs_multi.push_back(make_pair(-1, make_pair(make_pair(item.second.first.first, outputandvc[i]), -1)));
                 }
-                if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+                if (f->watch || (_IsWatched()))
                 {
                     *gWatchOut << "pushin into switch alloc swalloc update if output got" << f->id << "Switch allocation to do is " << _sw_alloc_vcs_multi.size() << endl;
                 }
@@ -4423,7 +4295,7 @@ void IQRouter::_SWAllocUpdateMulti()
 
             else
             {
-                if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+                if (f->watch || (_IsWatched()))
                 {
                     *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                         << "  No output port allocated." << endl;
@@ -4459,7 +4331,7 @@ void IQRouter::_SWAllocUpdateMulti()
     #endif
 
                 _sw_alloc_vcs_multi.push_back(make_pair(-1, make_pair(item.second.first, -1)));
-                if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+                if (f->watch || (_IsWatched()))
                 {
                     *gWatchOut << "pushin into switch alloc swallocupdate if output not got" << f->id << "Switch allocation to do is " << _sw_alloc_vcs_multi.size() << endl;
                 }
@@ -4472,13 +4344,13 @@ void IQRouter::_SWAllocUpdateMulti()
         }
         else {
         _sw_alloc_vcs_multi.push_back(make_pair(-1, make_pair(item.second.first, -1)));
-        if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+        if (f->watch || (_IsWatched()))
         {
             *gWatchOut << " push into switch alloc sw_alloc_update if output not got" << f->id << " Switch allocation to do is " << _sw_alloc_vcs_multi.size() << endl;
         }
 }
         _sw_alloc_vcs_multi.pop_front();
-        if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+        if (f->watch || (_IsWatched()))
         {
             *gWatchOut << " after pop front Switch allocation to do is " << _sw_alloc_vcs_multi.size() << endl;
         }
@@ -4499,7 +4371,12 @@ Flit * IQRouter::_Generate_Duplicates(Flit *cf , int output , bool generate_dup)
   else if(cf->type == Flit::WRITE_REPLY)
     temp_size = _write_reply_size;
   if(cf->head) {
-    if( generate_dup) {
+    if( generate_dup && ThreadPool::Parallel()) {
+      IdReservation const r = { cf->pid, output, temp_size };
+      mcast_map[cf->pid][output] = make_pair(-2 - (int)_id_reservations.size(), 0);
+      _id_reservations.push_back(r);
+    }
+    else if( generate_dup) {
       mcast_map[cf->pid][output] =  make_pair(_cur_pid,_cur_id);
       _cur_pid ++;
       _cur_id += temp_size; 
@@ -4528,12 +4405,16 @@ Flit * IQRouter::_Generate_Duplicates(Flit *cf , int output , bool generate_dup)
   f_dup->end = cf->end;
   f_dup->from_ddr = cf->from_ddr;
   f_dup->to_ddr = cf->to_ddr;
-  f_dup->layer_name = cf->layer_name;
+  f_dup->layer = cf->layer;
   f_dup->size = cf->size;
   f_dup->flits_num = cf->flits_num;
+  if(ThreadPool::Parallel()) {
+    _uncommitted_flits.push_back(f_dup);
+  } else {
     _total_in_flight_flits[f_dup->cl].insert(make_pair(f_dup->id, f_dup));
-  if(cf->record) {
-        _measured_in_flight_flits[f_dup->cl].insert(make_pair(f_dup->id, f_dup));
+    if(cf->record) {
+      _measured_in_flight_flits[f_dup->cl].insert(make_pair(f_dup->id, f_dup));
+    }
   }
 
   if(gTrace){
@@ -4554,7 +4435,7 @@ Flit * IQRouter::_Generate_Duplicates(Flit *cf , int output , bool generate_dup)
 
   f_dup->mflag = cf->mflag;
 
-  if (f_dup->watch || (_routers_to_watch.count(GetID()) > 0)) {
+  if (f_dup->watch || (_IsWatched())) {
       *gWatchOut << GetSimTime() << " | "
           << FullName() << " | " << " rid = " <<GetID() 
           << " Enqueuing Duplicate flit " << f_dup->id
@@ -4574,6 +4455,36 @@ Flit * IQRouter::_Generate_Duplicates(Flit *cf , int output , bool generate_dup)
   return f_dup;
 }
 
+void IQRouter::Commit()
+{
+  vector<pair<int, int> > base(_id_reservations.size());
+  for (size_t r = 0; r < _id_reservations.size(); ++r)
+  {
+    IdReservation const &res = _id_reservations[r];
+    base[r] = make_pair(_cur_pid, _cur_id);
+    _cur_pid++;
+    _cur_id += res.size;
+    pair<int, int> &entry = mcast_map[res.pid][res.output];
+    if (entry.first == -2 - (int)r)
+      entry = make_pair(base[r].first, base[r].second + entry.second);
+  }
+  for (size_t i = 0; i < _uncommitted_flits.size(); ++i)
+  {
+    Flit *const f = _uncommitted_flits[i];
+    if (f->pid <= -2)
+    {
+      pair<int, int> const &b = base[-2 - f->pid];
+      f->pid = b.first;
+      f->id += b.second;
+    }
+    _total_in_flight_flits[f->cl].insert(make_pair(f->id, f));
+    if (f->record)
+      _measured_in_flight_flits[f->cl].insert(make_pair(f->id, f));
+  }
+  _id_reservations.clear();
+  _uncommitted_flits.clear();
+}
+
 //------------------------------------------------------------------------------
 // switch traversal
 //------------------------------------------------------------------------------
@@ -4598,7 +4509,7 @@ void IQRouter::_SwitchEvaluate()
     int const expanded_input = iter->second.second.first;
     int const expanded_output = iter->second.second.second;
 
-    if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    if (f->watch || (_IsWatched()))
     {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                  << " beginning crossbar traversal for flit " << f->id
@@ -4635,7 +4546,7 @@ void IQRouter::_SwitchUpdate()
     int const output = expanded_output / _output_speedup;
     assert((output >= 0) && (output < _outputs));
 
-    if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    if (f->watch || (_IsWatched()))
     {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                  << " completed crossbar traversal for flit " << f->id
@@ -4647,7 +4558,7 @@ void IQRouter::_SwitchUpdate()
     }
     _switchMonitor->traversal(input, output, f);
 
-    if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    if (f->watch || (_IsWatched()))
     {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                  << " buffering flit " << f->id
@@ -4678,7 +4589,7 @@ void IQRouter::_OutputQueuing()
 
     Credit *const c = iter->second;
     assert(c);
-    assert(!c->vc.empty());
+    assert(c->HasVCs());
 
     _credit_buffer[input].push(c);
   }
@@ -4702,7 +4613,7 @@ void IQRouter::_SendFlits()
 #ifdef TRACK_FLOWS
       ++_sent_flits[f->cl][output];
 #endif
-      if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+      if (f->watch || (_IsWatched()))
         *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                    << " Sending flit " << f->id
                    << " to channel at output " << output
@@ -4735,6 +4646,21 @@ void IQRouter::_SendCredits()
 // misc.
 //------------------------------------------------------------------------------
 
+// flits and credits already queued for output are drained by WriteOutputs
+// even after the pipeline itself has gone idle
+bool IQRouter::IsActive() const
+{
+  if (_active)
+    return true;
+  for (int output = 0; output < _outputs; ++output)
+    if (!_output_buffer[output].empty())
+      return true;
+  for (int input = 0; input < _inputs; ++input)
+    if (!_credit_buffer[input].empty())
+      return true;
+  return false;
+}
+
 void IQRouter::Display(ostream &os) const
 {
   for (int input = 0; input < _inputs; ++input)
@@ -4816,7 +4742,7 @@ void IQRouter::_UpdateNOQ(int input, int vc, Flit const *f)
   assert(f);
   assert(f->vc == vc);
   assert(f->head);
-  set<OutputSet::sSetElement> sl = f->la_route_set.GetSet();
+  OutputSet sl = f->la_route_set.GetSet();
   assert(sl.size() == 1);
   int out_port = sl.begin()->output_port;
   const FlitChannel *channel = _output_channels[out_port];
@@ -4843,7 +4769,7 @@ void IQRouter::_UpdateNOQ(int input, int vc, Flit const *f)
     assert(_noq_next_vc_end[input][vc] < 0);
     _noq_next_vc_end[input][vc] = next_vc_end;
     assert(next_vc_start <= next_vc_end);
-    if (f->watch || (_routers_to_watch.count(GetID()) > 0))
+    if (f->watch || (_IsWatched()))
     {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " <<GetID() 
                  << " computing lookahead routing information for flit " << f->id
@@ -38,6 +38,8 @@
 
 #include "router.hpp"
 #include "../routefunc.hpp"
+#include "../watch_list.hpp"
+#include "../pipeline_stage.hpp"
 
 
 using namespace std;
@@ -80,18 +82,33 @@ public:
   map<int, Flit *> _in_queue_flits;
   map<int, map< int, pair<int,int> > > mcast_map;
 
+  // duplicates created during a parallel Evaluate get a placeholder packet
+  // id (-2 - index into _id_reservations) and an id offset; Commit hands out
+  // the real _cur_pid/_cur_id values in the order a serial run would
+  struct IdReservation {
+    int pid;
+    int output;
+    int size;
+  };
+  vector<IdReservation> _id_reservations;
+  vector<Flit *> _uncommitted_flits;
+
   deque<pair<int, pair<Credit *, int> > > _proc_credits;
 
   //MultiCast Structures
-  deque<pair<int, pair<int, int> > > _route_vcs_multi;//pair<time,pair<input,vc>> 
+  PipelineStage _route_vcs_multi;
   deque<pair<int, pair<pair<pair<int, int>, int >,int> > > _sw_alloc_vcs_multi;   //pair<time,pair<pair<pair<input,vc>,outputandvc,for switch>
+  // output VC found for each port of the multicast packet being allocated
+  vector<int> _mcast_empty_vc;
+  // cycle in which each expanded output was last given to a multicast copy
+  vector<int> _mcast_sw_claim;
   deque<pair<int, pair<pair<int, int>, pair<bool , int> > > > _vc_alloc_vcs_multi; //pair<time,pair<pair<input,vc>,pair<output,vc>> (each output port demand has an entry)
   deque<pair<int, pair<Flit *, pair<int, int> > > > _crossbar_flits_multi;
   
-  deque<pair<int, pair<int, int> > > _route_vcs;                //pair<time,pair<input,vc>> 
-  deque<pair<int, pair<pair<int, int>, int> > > _vc_alloc_vcs;  //pair<time,pair<pair<input,vc>,outputandvc=ourput*vcs+vc> 
-  deque<pair<int, pair<pair<int, int>, int> > > _sw_hold_vcs;
-  deque<pair<int, pair<pair<int, int>, int> > > _sw_alloc_vcs;
+  PipelineStage _route_vcs;
+  PipelineStage _vc_alloc_vcs;  // result: output*vcs+vc or stall
+  PipelineStage _sw_hold_vcs;
+  PipelineStage _sw_alloc_vcs;  // result: expanded output or stall
 
   deque<pair<int, pair<Flit *, pair<int, int> > > > _crossbar_flits;
 
@@ -121,7 +138,9 @@ public:
 
   set<int> _flits_to_watch;
   set<int> _packets_to_watch;
-  set<int> _routers_to_watch;
+  // this router is listed in watch_routers
+  bool _watched;
+  bool _IsWatched( ) const { return gWatchBuild && _watched; }
 
   bool _noq;
   vector<vector<int> > _noq_next_output_port;
@@ -138,9 +157,6 @@ public:
 
   virtual void _InternalStep( );
 
-  bool _Internal_Sub_Step(bool);
-  bool _Multi_Internal_Sub_Step(bool);
-
   bool _SWAllocAddReq(int input, int vc, int output);
   bool _SWAllocAddReqMulti(int input, int vc, int output);
 
@@ -164,6 +180,7 @@ public:
   void _VCAllocEvaluateMulti( );
   void _SWHoldEvaluateMulti( );
   void _SWAllocEvaluateMulti( );
+  void _SWAllocGrantMulti( );
   // void _SwitchEvaluateMulti( );
 
   void _RouteUpdateMulti( );
@@ -202,6 +219,10 @@ public:
 
   virtual void ReadInputs( );
   virtual void WriteOutputs( );
+
+  virtual bool IsActive( ) const;
+  virtual bool IsThreadSafe( ) const { return true; }
+  virtual void Commit( );
   
   void Display( ostream & os = cout ) const;
 
@@ -224,7 +245,7 @@ public:
   //Bransan adding fcfs queue of packet id's
   deque<std::pair<int,Flit *> > _out_queue; 
 
-  void addFlitMCastEntry(int dest, int outport, int input , int vc, int wflag);
+  void addFlitMCastEntry(const NodeSet & dests, int outport, int input , int vc, int wflag);
 
 
 };
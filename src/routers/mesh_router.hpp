@@ -0,0 +1,189 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*mesh_router.hpp
+ *
+ *IQRouter with the port and VC counts fixed at compile time, used for
+ *the common 2D mesh / DOR configuration (5 ports, one of the VC counts
+ *instantiated in Router::NewRouter). Channel I/O, activity checks and
+ *the per-VC credit snapshots run as fixed-trip loops over arrays of
+ *channel pointers; the pipeline stages themselves are shared with
+ *IQRouter, so timing and flit order are unchanged.
+ */
+
+#ifndef _MESH_ROUTER_HPP_
+#define _MESH_ROUTER_HPP_
+
+#include <cassert>
+
+#include "iq_router.hpp"
+#include "../globals.hpp"
+#include "../buffer_state.hpp"
+#include "../flitchannel.hpp"
+
+template <int Ports, int VCs>
+class MeshRouter : public IQRouter {
+
+  FlitChannel * _in_ch[Ports];
+  CreditChannel * _in_cr[Ports];
+  FlitChannel * _out_ch[Ports];
+  CreditChannel * _out_cr[Ports];
+
+public:
+
+  MeshRouter( Configuration const & config,
+	      Module *parent, string const & name, int id )
+    : IQRouter( config, parent, name, id, Ports, Ports )
+  {
+    assert(_vcs == VCs);
+    for ( int p = 0; p < Ports; ++p ) {
+      _in_ch[p] = 0;
+      _in_cr[p] = 0;
+      _out_ch[p] = 0;
+      _out_cr[p] = 0;
+    }
+  }
+
+  virtual void AddInputChannel( FlitChannel * channel, CreditChannel * backchannel )
+  {
+    int const input = _input_channels.size();
+    assert(input < Ports);
+    IQRouter::AddInputChannel( channel, backchannel );
+    _in_ch[input] = channel;
+    _in_cr[input] = backchannel;
+  }
+
+  virtual void AddOutputChannel( FlitChannel * channel, CreditChannel * backchannel )
+  {
+    int const output = _output_channels.size();
+    assert(output < Ports);
+    IQRouter::AddOutputChannel( channel, backchannel );
+    _out_ch[output] = channel;
+    _out_cr[output] = backchannel;
+  }
+
+  virtual void ReadInputs( )
+  {
+    bool activity = false;
+    for ( int input = 0; input < Ports; ++input ) {
+      Flit * const f = _in_ch[input]->Receive();
+      if ( f ) {
+#ifdef TRACK_FLOWS
+	++_received_flits[f->cl][input];
+#endif
+	if ( f->watch || _IsWatched() ) {
+	  *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " << GetID()
+		     << " Received flit " << f->id
+		     << " from channel at input " << input << " vc " << f->vc
+		     << "." << endl;
+	}
+	_in_queue_flits.insert( make_pair( input, f ) );
+	activity = true;
+      }
+    }
+    for ( int output = 0; output < Ports; ++output ) {
+      Credit * const c = _out_cr[output]->Receive();
+      if ( c ) {
+	_proc_credits.push_back( make_pair( GetSimTime() + _credit_delay,
+					    make_pair( c, output ) ) );
+	activity = true;
+      }
+    }
+    _active = _active || activity;
+  }
+
+  virtual void WriteOutputs( )
+  {
+    for ( int output = 0; output < Ports; ++output ) {
+      if ( !_output_buffer[output].empty() ) {
+	Flit * const f = _output_buffer[output].front();
+	assert(f);
+	_output_buffer[output].pop();
+#ifdef TRACK_FLOWS
+	++_sent_flits[f->cl][output];
+#endif
+	if ( f->watch || _IsWatched() )
+	  *gWatchOut << GetSimTime() << " | " << FullName() << " | " << " rid = " << GetID()
+		     << " Sending flit " << f->id
+		     << " to channel at output " << output
+		     << "." << endl;
+	if ( gTrace ) {
+	  cout << "Outport " << output << endl
+	       << "Stop Mark" << endl;
+	}
+	_out_ch[output]->Send( f );
+      }
+    }
+    for ( int input = 0; input < Ports; ++input ) {
+      if ( !_credit_buffer[input].empty() ) {
+	Credit * const c = _credit_buffer[input].front();
+	assert(c);
+	_credit_buffer[input].pop();
+	_in_cr[input]->Send( c );
+      }
+    }
+  }
+
+  virtual bool IsActive( ) const
+  {
+    if ( _active )
+      return true;
+    for ( int p = 0; p < Ports; ++p )
+      if ( !_output_buffer[p].empty() || !_credit_buffer[p].empty() )
+	return true;
+    return false;
+  }
+
+  virtual vector<int> UsedCredits( ) const
+  {
+    vector<int> result( Ports * VCs );
+    for ( int o = 0; o < Ports; ++o )
+      for ( int v = 0; v < VCs; ++v )
+	result[o * VCs + v] = _next_buf[o]->OccupancyFor( v );
+    return result;
+  }
+
+  virtual vector<int> FreeCredits( ) const
+  {
+    vector<int> result( Ports * VCs );
+    for ( int o = 0; o < Ports; ++o )
+      for ( int v = 0; v < VCs; ++v )
+	result[o * VCs + v] = _next_buf[o]->AvailableFor( v );
+    return result;
+  }
+
+  virtual vector<int> MaxCredits( ) const
+  {
+    vector<int> result( Ports * VCs );
+    for ( int o = 0; o < Ports; ++o )
+      for ( int v = 0; v < VCs; ++v )
+	result[o * VCs + v] = _next_buf[o]->LimitFor( v );
+    return result;
+  }
+};
+
+#endif
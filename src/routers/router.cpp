@@ -47,6 +47,7 @@
 #include "iq_router.hpp"
 #include "event_router.hpp"
 #include "chaos_router.hpp"
+#include "mesh_router.hpp"
 ///////////////////////////////////////////////////////
 
 int const Router::STALL_BUFFER_BUSY = -2;
@@ -91,6 +92,7 @@ void Router::AddInputChannel( FlitChannel *channel, CreditChannel *backchannel )
   _input_channels.push_back( channel );
   _input_credits.push_back( backchannel );
   channel->SetSink( this, _input_channels.size() - 1 ) ;
+  channel->SetReceiver( this );
 }
 
 void Router::AddInputChannel( PayloadChannel *channel, CreditChannel *backchannel )
@@ -98,6 +100,7 @@ void Router::AddInputChannel( PayloadChannel *channel, CreditChannel *backchanne
   _payload_in_channels.push_back( channel );
   // _input_credits.push_back( backchannel );
   channel->SetSink( this, _payload_in_channels.size() ) ;  //Bransan removed -1 here to make port values match
+  channel->SetReceiver( this );
 }
 
 void Router::AddOutputChannel( FlitChannel *channel, CreditChannel *backchannel )
@@ -106,6 +109,7 @@ void Router::AddOutputChannel( FlitChannel *channel, CreditChannel *backchannel
   _output_credits.push_back( backchannel );
   _channel_faults.push_back( false );
   channel->SetSource( this, _output_channels.size() - 1 ) ;
+  backchannel->SetReceiver( this );
 }
 
 void Router::AddOutputChannel( PayloadChannel *channel, CreditChannel *backchannel )
@@ -140,6 +144,28 @@ bool Router::IsFaultyOutput( int c ) const
 }
 
 /*Router constructor*/
+// 2D mesh routers under DOR get the fixed port/VC count IQRouter variant
+// when the VC count is one of the instantiated ones
+static Router *_NewMeshRouter( const Configuration& config,
+			       Module *parent, const string & name, int id,
+			       int inputs, int outputs, int is_hub )
+{
+  if ( !config.GetInt( "router_specialize" ) || is_hub ||
+       config.GetStr( "topology" ) != "mesh" || config.GetInt( "n" ) != 2 ||
+       config.GetStr( "routing_function" ) != "dor" ||
+       inputs != 5 || outputs != 5 )
+    return NULL;
+  switch ( config.GetInt( "num_vcs" ) ) {
+  case 1:  return new MeshRouter<5, 1>( config, parent, name, id );
+  case 2:  return new MeshRouter<5, 2>( config, parent, name, id );
+  case 4:  return new MeshRouter<5, 4>( config, parent, name, id );
+  case 8:  return new MeshRouter<5, 8>( config, parent, name, id );
+  case 16: return new MeshRouter<5, 16>( config, parent, name, id );
+  case 24: return new MeshRouter<5, 24>( config, parent, name, id );
+  }
+  return NULL;
+}
+
 Router *Router::NewRouter( const Configuration& config,
 			   Module *parent, const string & name, int id,
 			   int inputs, int outputs, int is_hub)
@@ -147,7 +173,9 @@ Router *Router::NewRouter( const Configuration& config,
   const string type = config.GetStr( "router" );
   Router *r = NULL;
   if ( type == "iq" ) {
-    r = new IQRouter( config, parent, name, id, inputs, outputs, is_hub);
+    r = _NewMeshRouter( config, parent, name, id, inputs, outputs, is_hub );
+    if ( !r )
+      r = new IQRouter( config, parent, name, id, inputs, outputs, is_hub);
   } else if ( type == "event" ) {
     r = new EventRouter( config, parent, name, id, inputs, outputs );
   } else if ( type == "chaos" ) {
@@ -0,0 +1,77 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*routetable.cpp
+ *
+ *Construction of the precomputed routing tables
+ */
+
+#include "routetable.hpp"
+
+bool RouteTable::Build( int routers, int dests, int max_entries, int (*next)( int cur, int dest ) )
+{
+  Clear( );
+  if ( ( long long )routers * dests > max_entries ) {
+    return false;
+  }
+  _dests = dests;
+  _ports.resize( routers * dests );
+  for ( int cur = 0; cur < routers; ++cur ) {
+    for ( int dest = 0; dest < dests; ++dest ) {
+      int const port = next( cur, dest );
+      assert( ( port >= 0 ) && ( port < 256 ) );
+      _ports[cur * dests + dest] = port;
+    }
+  }
+  return true;
+}
+
+void RouteTable::Clear( )
+{
+  _dests = 0;
+  vector<unsigned char>( ).swap( _ports );
+}
+
+void DimOrderTable::Build( int k, int n, int nodes )
+{
+  assert( ( k > 0 ) && ( k < 256 ) );
+  _n = n;
+  _digits.resize( nodes * n );
+  for ( int node = 0; node < nodes; ++node ) {
+    int id = node;
+    for ( int dim = 0; dim < n; ++dim ) {
+      _digits[node * n + dim] = id % k;
+      id /= k;
+    }
+  }
+}
+
+void DimOrderTable::Clear( )
+{
+  _n = 0;
+  vector<unsigned char>( ).swap( _digits );
+}
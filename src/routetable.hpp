@@ -0,0 +1,113 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*routetable.hpp
+ *
+ *Next-hop tables built once at startup for the regular topologies, so the
+ *routing functions do a lookup instead of taking node ids apart with
+ *divisions and modulos on every call.
+ *
+ *RouteTable is a dense router x destination table of output ports. It is
+ *only built while routers * destinations stays within the configured
+ *route_table_size; past that (a 64x64 mesh would need 16M entries) the
+ *mesh and torus functions fall back to a DimOrderTable, the base-k digits
+ *of every node, which is all dimension order routing needs to pick the
+ *next dimension without any arithmetic.
+ */
+
+#ifndef _ROUTETABLE_HPP_
+#define _ROUTETABLE_HPP_
+
+#include <vector>
+#include <cassert>
+
+using namespace std;
+
+class RouteTable {
+
+public:
+  RouteTable( ) : _dests(0) {}
+
+  // fill the table with next( cur, dest ), which must return a value in
+  // [0,255]; returns false (and leaves the table empty) if routers * dests
+  // exceeds max_entries
+  bool Build( int routers, int dests, int max_entries, int (*next)( int cur, int dest ) );
+  void Clear( );
+
+  bool Built( ) const { return !_ports.empty( ); }
+  int Lookup( int cur, int dest ) const
+  {
+    return _ports[cur * _dests + dest];
+  }
+
+private:
+  int _dests;
+  vector<unsigned char> _ports;
+};
+
+class DimOrderTable {
+
+public:
+  DimOrderTable( ) : _n(0) {}
+
+  void Build( int k, int n, int nodes );
+  void Clear( );
+
+  bool Built( ) const { return _n > 0; }
+
+  int Digit( int node, int dim ) const { return _digits[node * _n + dim]; }
+
+  // lowest / highest dimension in which the two nodes differ, or -1
+  int FirstDiff( int cur, int dest ) const
+  {
+    unsigned char const * c = &_digits[cur * _n];
+    unsigned char const * d = &_digits[dest * _n];
+    for ( int dim = 0; dim < _n; ++dim ) {
+      if ( c[dim] != d[dim] ) {
+        return dim;
+      }
+    }
+    return -1;
+  }
+  int LastDiff( int cur, int dest ) const
+  {
+    unsigned char const * c = &_digits[cur * _n];
+    unsigned char const * d = &_digits[dest * _n];
+    for ( int dim = _n - 1; dim >= 0; --dim ) {
+      if ( c[dim] != d[dim] ) {
+        return dim;
+      }
+    }
+    return -1;
+  }
+
+private:
+  int _n;
+  vector<unsigned char> _digits;
+};
+
+#endif
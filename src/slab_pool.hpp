@@ -0,0 +1,232 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*slab_pool.hpp
+ *
+ *Free-list allocator for the small objects that move through the network
+ *every cycle (flits, credits). Objects are constructed in slabs of
+ *contiguous storage and never destroyed individually: Get hands out a
+ *free object as it was left by Put, and the owner resets it.
+ *
+ *Each ThreadPool worker keeps its own free list and only takes the shared
+ *lock to move a batch to or from the shared list, so routers stepped in
+ *parallel do not contend on every flit. Outside of a parallel phase all
+ *accesses come from worker 0 and no lock is taken at all.
+ *
+ *Trim returns slabs whose objects are all free to the system; it must be
+ *called between phases.
+ */
+
+#ifndef _SLAB_POOL_HPP_
+#define _SLAB_POOL_HPP_
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "thread_pool.hpp"
+
+using namespace std;
+
+template <class T>
+class SlabPool {
+
+public:
+  explicit SlabPool( int slab_size = 256 )
+    : _slab_size( slab_size ), _peak_slabs( 0 ) { }
+  ~SlabPool( ) { Clear( ); }
+
+  T * Get( )
+  {
+    int const w = ThreadPool::Worker( );
+    if ( w >= MAX_CACHES ) {
+      lock_guard<mutex> lock( _lock );
+      if ( _shared.empty( ) ) {
+	_Grow( );
+      }
+      T * const p = _shared.back( );
+      _shared.pop_back( );
+      return p;
+    }
+    vector<T *> & cache = _caches[w].free;
+    if ( cache.empty( ) ) {
+      _Refill( cache );
+    }
+    T * const p = cache.back( );
+    cache.pop_back( );
+    return p;
+  }
+
+  void Put( T * p )
+  {
+    int const w = ThreadPool::Worker( );
+    if ( w >= MAX_CACHES ) {
+      lock_guard<mutex> lock( _lock );
+      _shared.push_back( p );
+      return;
+    }
+    vector<T *> & cache = _caches[w].free;
+    cache.push_back( p );
+    if ( (int)cache.size( ) > 2 * BATCH ) {
+      _Spill( cache );
+    }
+  }
+
+  // objects handed out and not yet returned
+  int Live( ) const
+  {
+    size_t free = _shared.size( );
+    for ( int w = 0; w < MAX_CACHES; ++w ) {
+      free += _caches[w].free.size( );
+    }
+    return (int)( _slabs.size( ) * _slab_size - free );
+  }
+
+  void Trim( )
+  {
+    assert( !ThreadPool::Parallel( ) );
+    for ( int w = 0; w < MAX_CACHES; ++w ) {
+      vector<T *> & cache = _caches[w].free;
+      _shared.insert( _shared.end( ), cache.begin( ), cache.end( ) );
+      cache.clear( );
+    }
+    if ( (int)_shared.size( ) < _slab_size ) {
+      return;
+    }
+    // a slab is idle when all of its objects are on the free list; with
+    // both lists sorted that is a run of _slab_size consecutive entries
+    // starting at the slab itself
+    sort( _shared.begin( ), _shared.end( ), less<T *>( ) );
+    sort( _slabs.begin( ), _slabs.end( ), less<T *>( ) );
+    vector<T *> keep_free;
+    vector<T *> keep_slabs;
+    size_t f = 0;
+    for ( size_t s = 0; s < _slabs.size( ); ++s ) {
+      T * const slab = _slabs[s];
+      while ( ( f < _shared.size( ) ) && less<T *>( )( _shared[f], slab ) ) {
+	keep_free.push_back( _shared[f++] );
+      }
+      if ( ( f + _slab_size <= _shared.size( ) ) &&
+	   ( _shared[f + _slab_size - 1] == slab + _slab_size - 1 ) ) {
+	_Release( slab );
+	f += _slab_size;
+      } else {
+	keep_slabs.push_back( slab );
+      }
+    }
+    keep_free.insert( keep_free.end( ), _shared.begin( ) + f, _shared.end( ) );
+    _shared.swap( keep_free );
+    _slabs.swap( keep_slabs );
+  }
+
+  // destroys every object, including those still handed out
+  void Clear( )
+  {
+    for ( size_t s = 0; s < _slabs.size( ); ++s ) {
+      _Release( _slabs[s] );
+    }
+    _slabs.clear( );
+    _shared.clear( );
+    for ( int w = 0; w < MAX_CACHES; ++w ) {
+      _caches[w].free.clear( );
+    }
+  }
+
+  void Display( ostream & os, const char * name ) const
+  {
+    os << name << " pool: peak " << _peak_slabs * _slab_size << " objects ("
+       << ( _peak_slabs * _slab_size * sizeof( T ) + 1023 ) / 1024 << " KB), "
+       << _slabs.size( ) * _slab_size << " held, "
+       << Live( ) << " live" << endl;
+  }
+
+private:
+  static const int MAX_CACHES = 64;
+  static const int BATCH = 64;
+
+  // padded so that neighbouring workers do not share a cache line
+  struct Cache {
+    vector<T *> free;
+    char pad[64 - sizeof( vector<T *> )];
+  };
+
+  int _slab_size;
+  size_t _peak_slabs;
+
+  vector<T *> _slabs;
+  vector<T *> _shared;
+  mutex _lock;
+  Cache _caches[MAX_CACHES];
+
+  void _Grow( )
+  {
+    T * const slab = static_cast<T *>( ::operator new( _slab_size * sizeof( T ) ) );
+    for ( int i = _slab_size - 1; i >= 0; --i ) {
+      _shared.push_back( new ( slab + i ) T );
+    }
+    _slabs.push_back( slab );
+    _peak_slabs = max( _peak_slabs, _slabs.size( ) );
+  }
+
+  void _Release( T * slab )
+  {
+    for ( int i = 0; i < _slab_size; ++i ) {
+      slab[i].~T( );
+    }
+    ::operator delete( slab );
+  }
+
+  void _Refill( vector<T *> & cache )
+  {
+    unique_lock<mutex> lock( _lock, defer_lock );
+    if ( ThreadPool::Parallel( ) ) {
+      lock.lock( );
+    }
+    if ( _shared.empty( ) ) {
+      _Grow( );
+    }
+    size_t const n = min( (size_t)BATCH, _shared.size( ) );
+    cache.insert( cache.end( ), _shared.end( ) - n, _shared.end( ) );
+    _shared.resize( _shared.size( ) - n );
+  }
+
+  void _Spill( vector<T *> & cache )
+  {
+    unique_lock<mutex> lock( _lock, defer_lock );
+    if ( ThreadPool::Parallel( ) ) {
+      lock.lock( );
+    }
+    _shared.insert( _shared.end( ), cache.end( ) - BATCH, cache.end( ) );
+    cache.resize( cache.size( ) - BATCH );
+  }
+};
+
+#endif
@@ -0,0 +1,149 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*thread_pool.cpp
+ *
+ *Work-stealing pool used by Network to step routers and channels of one
+ *phase in parallel, see thread_pool.hpp
+ */
+
+#include <algorithm>
+#include <cassert>
+
+#include "thread_pool.hpp"
+#include "timed_module.hpp"
+
+// modules claimed per fetch; small so that busy routers even out
+static int const CHUNK_SIZE = 4;
+// busy-wait iterations before a waiting thread starts yielding its core
+static int const SPIN_LIMIT = 1024;
+
+thread_local int ThreadPool::_worker = 0;
+bool ThreadPool::_parallel = false;
+
+ThreadPool::ThreadPool( int threads )
+  : _threads( threads ), _phase( EVALUATE ),
+    _generation( 0 ), _pending( 0 ), _quit( false )
+{
+  _slices = new Slice[_threads];
+  for ( int w = 1; w < _threads; ++w ) {
+    _workers.push_back( thread( &ThreadPool::_Loop, this, w ) );
+  }
+}
+
+ThreadPool::~ThreadPool( )
+{
+  _quit.store( true, memory_order_release );
+  _generation.fetch_add( 1, memory_order_release );
+  for ( size_t w = 0; w < _workers.size( ); ++w ) {
+    _workers[w].join( );
+  }
+  delete [] _slices;
+}
+
+void ThreadPool::Step( vector<TimedModule *> const & modules,
+		       int begin, int end, Phase phase )
+{
+  switch ( phase ) {
+  case READ_INPUTS:
+    for ( int i = begin; i < end; ++i ) modules[i]->ReadInputs( );
+    break;
+  case EVALUATE:
+    for ( int i = begin; i < end; ++i ) modules[i]->Evaluate( );
+    break;
+  case WRITE_OUTPUTS:
+    for ( int i = begin; i < end; ++i ) modules[i]->WriteOutputs( );
+    break;
+  case EVALUATE_WRITE:
+    for ( int i = begin; i < end; ++i ) {
+      modules[i]->Evaluate( );
+      modules[i]->WriteOutputs( );
+    }
+    break;
+  }
+}
+
+void ThreadPool::Run( vector<vector<TimedModule *> > const & regions, Phase phase )
+{
+  assert( (int)regions.size( ) == _threads );
+  for ( int w = 0; w < _threads; ++w ) {
+    _slices[w].next.store( 0, memory_order_relaxed );
+    _slices[w].end = regions[w].size( );
+    _slices[w].modules = &regions[w];
+  }
+  _phase = phase;
+  _parallel = true;
+  _pending.store( _threads - 1, memory_order_relaxed );
+  _generation.fetch_add( 1, memory_order_release );
+
+  _Work( 0 );
+
+  int spins = 0;
+  while ( _pending.load( memory_order_acquire ) > 0 ) {
+    if ( ++spins > SPIN_LIMIT ) {
+      this_thread::yield( );
+    }
+  }
+  _parallel = false;
+}
+
+void ThreadPool::_Loop( int worker )
+{
+  _worker = worker;
+  int seen = 0;
+  while ( true ) {
+    int spins = 0;
+    int generation;
+    while ( ( generation = _generation.load( memory_order_acquire ) ) == seen ) {
+      if ( ++spins > SPIN_LIMIT ) {
+	this_thread::yield( );
+      }
+    }
+    seen = generation;
+    if ( _quit.load( memory_order_acquire ) ) {
+      return;
+    }
+    _Work( worker );
+    _pending.fetch_sub( 1, memory_order_release );
+  }
+}
+
+// drain the own slice first, then steal from the others in turn
+void ThreadPool::_Work( int worker )
+{
+  for ( int i = 0; i < _threads; ++i ) {
+    _Drain( _slices[( worker + i ) % _threads] );
+  }
+}
+
+void ThreadPool::_Drain( Slice & slice )
+{
+  int begin;
+  while ( ( begin = slice.next.fetch_add( CHUNK_SIZE, memory_order_relaxed ) ) < slice.end ) {
+    Step( *slice.modules, begin, min( begin + CHUNK_SIZE, slice.end ), _phase );
+  }
+}
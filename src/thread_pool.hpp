@@ -0,0 +1,100 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*thread_pool.hpp
+ *
+ *Steps timed modules in parallel for one phase of a cycle. Each worker
+ *owns one region of the network (see Network::_InitScheduler) and steals
+ *from the other regions once its own is done; Run returns after every
+ *module has been stepped, which acts as the barrier between phases.
+ *
+ *The calling thread takes part as worker 0.
+ */
+
+#ifndef _THREAD_POOL_HPP_
+#define _THREAD_POOL_HPP_
+
+#include <vector>
+#include <thread>
+#include <atomic>
+
+using namespace std;
+
+class TimedModule;
+
+class ThreadPool {
+
+public:
+  // EVALUATE_WRITE runs Evaluate and WriteOutputs back to back per module
+  enum Phase { READ_INPUTS, EVALUATE, WRITE_OUTPUTS, EVALUATE_WRITE };
+
+  ThreadPool( int threads );
+  ~ThreadPool( );
+
+  inline int NumThreads( ) const { return _threads; }
+
+  // regions[w] is worked on by worker w first; one region per thread
+  void Run( vector<vector<TimedModule *> > const & regions, Phase phase );
+
+  // steps modules [begin, end) on the calling thread
+  static void Step( vector<TimedModule *> const & modules,
+		    int begin, int end, Phase phase );
+
+  // index of the calling worker, 0 outside of the pool
+  static inline int Worker( ) { return _worker; }
+  // true while a phase is being run in parallel
+  static inline bool Parallel( ) { return _parallel; }
+
+private:
+  // the unclaimed part of one region; padded so that workers claiming from
+  // different regions do not share a cache line
+  struct Slice {
+    atomic<int> next;
+    int end;
+    vector<TimedModule *> const * modules;
+    char pad[64 - sizeof(atomic<int>) - sizeof(int) - sizeof(void *)];
+  };
+
+  int _threads;
+  vector<thread> _workers;
+  Slice * _slices;
+
+  Phase _phase;
+
+  atomic<int> _generation;
+  atomic<int> _pending;
+  atomic<bool> _quit;
+
+  static thread_local int _worker;
+  static bool _parallel;
+
+  void _Loop( int worker );
+  void _Work( int worker );
+  void _Drain( Slice & slice );
+};
+
+#endif
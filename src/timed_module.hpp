@@ -28,17 +28,54 @@
 #ifndef _TIMED_MODULE_HPP_
 #define _TIMED_MODULE_HPP_
 
+#include <vector>
+#include <atomic>
+
 #include "module.hpp"
+#include "thread_pool.hpp"
 
 class TimedModule : public Module {
 
 public:
-  TimedModule(Module * parent, string const & name) : Module(parent, name) {}
+  TimedModule(Module * parent, string const & name)
+    : Module(parent, name), _order(-1), _woken(false), _wake_lists(0) {}
   virtual ~TimedModule() {}
   
   virtual void ReadInputs() = 0;
   virtual void Evaluate() = 0;
   virtual void WriteOutputs() = 0;
+
+  // conservative default: modules that cannot tell are never skipped
+  virtual bool IsActive() const { return true; }
+
+  // modules that only touch their own state (and the channels they read or
+  // write) may be stepped concurrently with others of the same phase
+  virtual bool IsThreadSafe() const { return false; }
+  // called serially, in module order, after a parallel Evaluate
+  virtual void Commit() {}
+
+  // active-set scheduling: a module that is not active is only stepped
+  // again once a neighbour wakes it, e.g. by sending it a flit or credit
+  void SetScheduler(vector<vector<TimedModule *> > * wake_lists, int order) {
+    _wake_lists = wake_lists;
+    _order = order;
+  }
+  inline int GetOrder() const { return _order; }
+  // may be called from any worker thread; each worker has its own list
+  inline void Wake() {
+    if(_wake_lists && !_woken.load(memory_order_relaxed) &&
+       !_woken.exchange(true, memory_order_relaxed)) {
+      (*_wake_lists)[ThreadPool::Worker()].push_back(this);
+    }
+  }
+  inline bool ClearWoken() {
+    return _woken.exchange(false, memory_order_relaxed);
+  }
+
+private:
+  int _order;
+  atomic<bool> _woken;
+  vector<vector<TimedModule *> > * _wake_lists;
 };
 
 #endif
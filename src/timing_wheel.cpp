@@ -0,0 +1,85 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*timing_wheel.cpp
+ *
+ *see timing_wheel.hpp
+ */
+
+#include "timing_wheel.hpp"
+
+TimingWheel::TimingWheel( )
+  : _now( -1 ), _mask( 0 )
+{
+}
+
+void TimingWheel::Resize( int horizon, int workers )
+{
+  assert( IsIdle( ) );
+  // a send issued before this cycle's Advance is due horizon + 1 slots on
+  int size = 1;
+  while ( size < horizon + 2 ) {
+    size <<= 1;
+  }
+  _mask = size - 1;
+  _slots.assign( size, vector<vector<Client *> >( workers ) );
+}
+
+void TimingWheel::Advance( int time )
+{
+  for ( vector<Client *>::const_iterator iter = _delivered.begin( );
+	iter != _delivered.end( ); ++iter ) {
+    (*iter)->Retire( );
+  }
+  _delivered.clear( );
+
+  vector<vector<Client *> > & slot = _slots[time & _mask];
+  for ( size_t w = 0; w < slot.size( ); ++w ) {
+    for ( vector<Client *>::const_iterator iter = slot[w].begin( );
+	  iter != slot[w].end( ); ++iter ) {
+      (*iter)->Deliver( );
+      _delivered.push_back( *iter );
+    }
+    slot[w].clear( );
+  }
+  _now = time;
+}
+
+bool TimingWheel::IsIdle( ) const
+{
+  if ( !_delivered.empty( ) ) {
+    return false;
+  }
+  for ( size_t s = 0; s < _slots.size( ); ++s ) {
+    for ( size_t w = 0; w < _slots[s].size( ); ++w ) {
+      if ( !_slots[s][w].empty( ) ) {
+	return false;
+      }
+    }
+  }
+  return true;
+}
@@ -0,0 +1,86 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*timing_wheel.hpp
+ *
+ *Delivery schedule shared by all channels of a network. A channel that
+ *is sent data registers itself in the slot of the cycle the data comes
+ *due; each cycle only the channels in that slot are touched, instead of
+ *polling every channel's queue.
+ *
+ *The wheel has one slot per cycle up to the longest channel latency, so
+ *a slot is reused once its cycle has passed.
+ */
+
+#ifndef _TIMING_WHEEL_HPP_
+#define _TIMING_WHEEL_HPP_
+
+#include <vector>
+#include <cassert>
+
+#include "thread_pool.hpp"
+
+using namespace std;
+
+class TimingWheel {
+
+public:
+  class Client {
+  public:
+    virtual ~Client( ) {}
+    // the oldest item in flight becomes visible at the output
+    virtual void Deliver( ) = 0;
+    // the item delivered in the previous cycle has been read
+    virtual void Retire( ) = 0;
+  };
+
+  TimingWheel( );
+
+  // horizon is the longest delay that will be scheduled; each worker of a
+  // ThreadPool gets its own lists so that Schedule needs no locking
+  void Resize( int horizon, int workers );
+  inline bool IsReady( ) const { return !_slots.empty( ); }
+
+  // time must lie within the horizon passed to Resize
+  inline void Schedule( Client * c, int time ) {
+    assert( time > _now );
+    _slots[time & _mask][ThreadPool::Worker( )].push_back( c );
+  }
+
+  // retires last cycle's deliveries and delivers everything due at time
+  void Advance( int time );
+
+  bool IsIdle( ) const;
+
+private:
+  int _now;
+  int _mask;
+  vector<vector<vector<Client *> > > _slots; // [slot][worker]
+  vector<Client *> _delivered;
+};
+
+#endif
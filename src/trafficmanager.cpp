@@ -38,6 +38,7 @@
 #include <limits>
 #include <cstdlib>
 #include <ctime>
+#include <chrono>
 #include <time.h>
 
 #include "booksim.hpp"
@@ -384,6 +385,32 @@ TrafficManager::TrafficManager(const Configuration &config, const vector<Network
 
     _hold_switch_for_packet = config.GetInt("hold_switch_for_packet");
 
+    _fast_forward = (config.GetInt("fast_forward") > 0);
+    if (_fast_forward && (gTrace || (config.GetFloat("internal_speedup") != 1.0)))
+    {
+        cout << "WARNING: fast_forward requires viewer_trace=0 and internal_speedup=1.0, disabled." << endl;
+        _fast_forward = false;
+    }
+
+    _pool_trim = (config.GetInt("pool_trim") > 0);
+
+    _pool = NULL;
+    int const sim_threads = config.GetInt("sim_threads");
+    double const speedup = config.GetFloat("internal_speedup");
+    if (sim_threads > 1)
+    {
+        if (gTrace || gWatchOut || (floor(speedup) != speedup))
+        {
+            cout << "WARNING: sim_threads requires viewer_trace=0, no watch_out and an integral internal_speedup, running serially." << endl;
+        }
+        else
+        {
+            _pool = new ThreadPool(sim_threads);
+            for (size_t i = 0; i < _net.size(); ++i)
+                _net[i]->SetThreadPool(_pool);
+        }
+    }
+
     // ============ Simulation parameters ============
 
     _total_sims = config.GetInt("sim_count");
@@ -395,7 +422,6 @@ TrafficManager::TrafficManager(const Configuration &config, const vector<Network
         _router[i] = _net[i]->GetRouters();
         _hub[i] = _net[i]->GetHubs();
     }
-    json j;
     switch (config.GetInt("network")) {
     case 0:
         net_name = "darknet19";
@@ -482,9 +508,26 @@ TrafficManager::TrafficManager(const Configuration &config, const vector<Network
     //string ifile = route + "p.json";
     //route = route + net_name + "_" + to_string(dim_x) + "x" + to_string(dim_y) + "_batch" + to_string(batch);
     route = route+"\\IR_" + tempmet;
-    string ifile = route  + ".json";
-    cout<<ifile;
-    std::ifstream(ifile) >> j;
+    string ifile = config.GetStr("ir_file");
+    if (ifile.empty())
+        ifile = route  + ".json";
+    cout << ifile << endl;
+    chrono::steady_clock::time_point load_start = chrono::steady_clock::now();
+    string ir_error;
+    if (!_ir.Load(ifile, ir_error))
+    {
+        Error("Cannot load workload IR " + ifile + ": " + ir_error);
+    }
+    _ir.InternLayers(&Flit::InternLayer);
+    double load_ms = chrono::duration<double, milli>(chrono::steady_clock::now() - load_start).count();
+    cout << "Workload IR: " << _ir.TotalWorkloads() << " workloads, " << _ir.NumLayers() << " layers, "
+         << (_ir.Bytes() + 1023) / 1024 << " KB" << (_ir.Mapped() ? " mapped" : "")
+         << ", loaded in " << load_ms << " ms" << endl;
+    if (!_paint.Open(route + "_paint.jsonl"))
+    {
+        Error("Cannot create " + route + "_paint.jsonl");
+    }
+    _paint_json = (config.GetInt("paint_json") > 0);
     //std::ifstream("C:\\Users\\JingweiCai\\Desktop\\stschedule\\stschedule\\stschedule\\results\\resnet_3x3_batch8\\IR.json") >> j;
     //std::ifstream("C:\\Users\\JingweiCai\\Desktop\\stschedule\\stschedule\\stschedule\\results\\goog_8x8_batch16\\IR.json") >> j;
     //std::ifstream("C:\\Users\\JingweiCai\\Desktop\\0_3_64_4_2_nocbw_48_LP-SA.json") >> j;
@@ -510,7 +553,7 @@ TrafficManager::TrafficManager(const Configuration &config, const vector<Network
     for (int i = 0; i < dim_y; i++) {
         for (int k = 0; k < dim_x + 2; k++) {
             if (k != 0 && k != dim_x + 1) {
-                Core* temp = new Core(config, i * (dim_x+2) + k,ddr_routers, j);
+                Core* temp = new Core(config, i * (dim_x+2) + k,ddr_routers, _ir, _paint);
                 _core[i * (dim_x + 2) + k] = temp;
                 core_id.insert(i * (dim_x + 2) + k);
 //                cout << i * (x_temp + 2) + k << "\n";
@@ -554,11 +597,21 @@ if (k == 0) {
         for (int p = 0; p < ddr_routers.size() / _ddrs; p++) {
             temp1[p] = ddr_routers[p];
         }
-        DDR* temp = new DDR(config,temp1, i, j);
+        DDR* temp = new DDR(config,temp1, i, _ir);
         _ddr[i] = temp;
         
     }
    
+    _ejected.resize(_subnets);
+    for (auto& e : _ejected) {
+        e.reserve(_nodes);
+    }
+    _ddr_empty_routers.resize(_ddrs);
+    for (auto& m : _ddr_empty_routers) {
+        m.reserve(ddr_routers.size() / _ddrs);
+    }
+    _ddr_empty.resize(_ddrs, false);
+
     int temp_r = ddr_routers.size() / _ddrs;
     assert(ddr_routers.size() % _ddrs==0);
     int temp_p =0;
@@ -568,6 +621,30 @@ if (k == 0) {
         temp_p = temp_p + 1;
     }
 
+    // endpoints 0 .. _ddrs - 1 are the DDRs, followed by one per core
+    _endpoint.assign(_nodes, -1);
+    for (int d = 0; d < _ddrs; ++d)
+    {
+        _endpoint_ddr.push_back(d);
+        _endpoint_nodes.push_back(vector<int>());
+    }
+    for (int i = 0; i < _nodes; ++i)
+    {
+        if (core_id.count(i) > 0)
+        {
+            _endpoint[i] = _endpoint_nodes.size();
+            _endpoint_nodes.push_back(vector<int>(1, i));
+            _endpoint_ddr.push_back(-1);
+        }
+        else if (ddr_id.count(i) > 0)
+        {
+            _endpoint[i] = ddr_id[i];
+            _endpoint_nodes[ddr_id[i]].push_back(i);
+        }
+    }
+    _woken.reserve(_endpoint_nodes.size());
+    _woken_nodes.reserve(core_id.size() + ddr_routers.size());
+
     //seed the network
     int seed;
     if (config.GetStr("seed") == "time")
@@ -661,7 +738,7 @@ if (k == 0) {
     vector<int> watch_routers = config.GetIntArray("watch_routers");
     for (size_t i = 0; i < watch_routers.size(); ++i)
     {
-        _routers_to_watch.insert(watch_routers[i]);
+        _routers_to_watch.Insert(watch_routers[i]);
     }
     string stats_out_file = config.GetStr("stats_out");
     if (stats_out_file == "")
@@ -958,6 +1035,8 @@ TrafficManager::~TrafficManager()
         }
     }
 
+    delete _pool;
+
     if (gWatchOut && (gWatchOut != &cout))
         delete gWatchOut;
     if (_stats_out && (_stats_out != &cout))
@@ -1029,21 +1108,21 @@ void TrafficManager::_RetireFlit(Flit *f, int dest)
             << ", transfer_id = " << f->transfer_id
             << ", from_ddr =" <<f->from_ddr
             << ", size =" <<f->size
-            << " layer_name =" << f->layer_name
+            << " layer_name =" << Flit::LayerName(f->layer)
             << ", hops = " << f->hops
             << ", flat = " << f->atime - f->itime
             << ")." << endl;
          *gWatchOut  << " multi Destinations are: ";
-            for (int i = 0; i < f->mdest.first.size(); i++) {
-                *gWatchOut << f->mdest.first[i] << " " << endl;
+            for (int d = f->GetMdest().first.First(); d >= 0; d = f->GetMdest().first.Next(d)) {
+                *gWatchOut << d << " " << endl;
             }
-         *gWatchOut << "num dests " << f->mdest.first.size() << " simtime " << GetSimTime() << " source " << f->src << endl;
+         *gWatchOut << "num dests " << f->GetMdest().first.Size() << " simtime " << GetSimTime() << " source " << f->src << endl;
     }
 
     if (!f->dropped)
     {
          
-        if (f->head && ((f->mflag == 0 && f->dest != dest)||(f->mflag ==1 && f->mdest.first.size()==1 && f->mdest.first[0] != dest)))
+        if (f->head && ((f->mflag == 0 && f->dest != dest)||(f->mflag ==1 && f->GetMdest().first.Size()==1 && !f->GetMdest().first.Contains(dest))))
         {
             ostringstream err;
             cout<<f->dest <<endl;
@@ -1233,7 +1312,7 @@ int TrafficManager::_IssuePacket(int source, int cl)
 }
 
 
-vector<int> TrafficManager::_GetMcastDests(int source)
+NodeSet TrafficManager::_GetMcastDests(int source)
 {
     // srand(GetSimTime()+source);
     // int num_dests = rand()%13 + 4;
@@ -1245,7 +1324,7 @@ vector<int> TrafficManager::_GetMcastDests(int source)
         Error(err.str());
     }
     vector<int> total_set;
-    vector<int> dests;
+    NodeSet dests;
     for(int i = 0;i < gNodes; i++)
     {
         if(i == source )
@@ -1259,22 +1338,22 @@ vector<int> TrafficManager::_GetMcastDests(int source)
 
         int val = total_set[rand()%(total_set.size()) ];
         total_set.erase(find(total_set.begin(), total_set.end(), val));
-        dests.push_back(val);
+        dests.Insert(val);
     }
     
     return dests;
 }
 
-int hop_calculator(int source, vector<int> dests)
+int hop_calculator(int source, const NodeSet & dests)
 {
     int total = 0;
     int src_row = source / gK;
     int src_col = source % gK;
     int dst_row, dst_col;
-    for(int i = 0; i < dests.size(); i++)
+    for(int d = dests.First(); d >= 0; d = dests.Next(d))
     {
-        dst_row = dests[i] / gK;
-        dst_col = dests[i] % gK;
+        dst_row = d / gK;
+        dst_col = d % gK;
         total += (abs(dst_row - src_row)+ abs(dst_col - src_col));
     }
 
@@ -1395,7 +1474,7 @@ void TrafficManager::_GeneratePacket(int source, int stype,
 
     int subnetwork = ((packet_type == Flit::ANY_TYPE) ? RandomInt(_subnets - 1) : _subnet[packet_type]);
 
-    if (watch || (_routers_to_watch.count(source) > 0))
+    if (watch || (_routers_to_watch.Contains(source)))
     {
         *gWatchOut << GetSimTime() << " | "
                    << "node" << source << " | "
@@ -1404,7 +1483,7 @@ void TrafficManager::_GeneratePacket(int source, int stype,
                    << "." << endl;
     }
      mcast_flag = ((float)rand()/RAND_MAX) < _mcast_load;
-    vector<int> temp;
+    NodeSet temp;
     for (int i = 0; i < size; ++i)
     {
         Flit *f = Flit::New();
@@ -1494,7 +1573,7 @@ void TrafficManager::_GeneratePacket(int source, int stype,
                     latest_mdnd_hop = hop_calculator(source, temp);
                     non_mdnd_hops += latest_mdnd_hop;
                 }
-                f->mdest = make_pair(temp, vector <int > {});
+                f->MutableMdest().first = temp;
                 if(f->tail)
                 {
                     f_orig_ctime[f->id] = f->ctime;
@@ -1502,20 +1581,20 @@ void TrafficManager::_GeneratePacket(int source, int stype,
                     f_diff1[f->id] = 0;
                     mcast_flag = false; 
                 }
-                 if(f->head && f->watch || (_routers_to_watch.count(source) > 0))
+                 if(f->head && f->watch || (_routers_to_watch.Contains(source)))
                  {
                      *gWatchOut<<"Pid "<<f->pid<<" Destinations are: "<<endl;
-                     for(int i = 0; i < f->mdest.first.size() ; i++){
-                         *gWatchOut <<f->mdest.first[i]<<" ";
+                     for (int d = f->GetMdest().first.First(); d >= 0; d = f->GetMdest().first.Next(d)) {
+                         *gWatchOut <<d<<" ";
                      }
-                     *gWatchOut <<"num dests "<<f->mdest.first.size()<<" simtime "<<GetSimTime()<<" source " << source<<endl;
+                     *gWatchOut <<"num dests "<<f->GetMdest().first.Size()<<" simtime "<<GetSimTime()<<" source " << source<<endl;
                 }
             }
         }
         
 
         
-        if (f->watch || (_routers_to_watch.count(source) > 0))
+        if (f->watch || (_routers_to_watch.Contains(source)))
         {
             *gWatchOut << GetSimTime() << " | "
                        << "node" << source << " | "
@@ -1523,7 +1602,7 @@ void TrafficManager::_GeneratePacket(int source, int stype,
                        << " (packet " << f->pid
                        << ") at time " << _time
                        << " transfer_id = "<<f->transfer_id
-                       << " layer_name =" <<f->layer_name
+                       << " layer_name =" <<Flit::LayerName(f->layer)
                        << " to node " << f->dest
                        << " | mcast " << f->mflag
                        << "." << endl;
@@ -1539,16 +1618,15 @@ void TrafficManager::_GeneratePacket(int source, int stype,
 
 void TrafficManager::_Inject()
 {
-    vector<vector<int>> empty_router;
-    vector<bool> empty_result;
-    empty_router.resize(_ddrs);
+    vector<vector<int> >& empty_router = _ddr_empty_routers;
+    vector<bool>& empty_result = _ddr_empty;
     for (auto& m : empty_router) {
-        m.reserve(ddr_routers.size() / _ddrs);
+        m.clear();
     }
     if (_time == 28095) {
         cout << "here";
     }
-    empty_result.resize(_ddrs,false);
+    empty_result.assign(_ddrs, false);
  //   for (int i = 0; i < _nodes; ++i) {
         for (auto i : ddr_routers) {
             if (_partial_packets[i][0].empty()) {
@@ -1558,15 +1636,18 @@ void TrafficManager::_Inject()
         }
 //    }
 
+    _WakeEndpoints();
+
     Flit::FlitType packet_type = Flit::ANY_TYPE;
-    for (int i = 0; i < _nodes; ++i)
+    for (int i : _woken_nodes)
     {
         //int input = rand_inputs[i];
         if (core_id.count(i) > 0 || ddr_id.count(i)>0) {
  //           cout << _cur_id<<"\n";
             assert(!(core_id.count(i) > 0 && ddr_id.count(i) > 0));
              for (int c = 0; c < _classes; ++c){
-                 list<Flit*> flits{};
+                 vector<Flit*>& flits = _new_flits;
+                 flits.clear();
                  if (core_id.count(i) > 0) {
                       _core[i]->run(_time, _partial_packets[i][c].empty(),flits);
                  }
@@ -1593,7 +1674,7 @@ void TrafficManager::_Inject()
                             if(f->mflag){
                             mcastcount++;
                             f->oid = f->id;
-                            latest_mdnd_hop = hop_calculator(i, f->mdest.first);
+                            latest_mdnd_hop = hop_calculator(i, f->GetMdest().first);
                             non_mdnd_hops += latest_mdnd_hop;
                             mflag_temp = f->mflag;
                             }
@@ -1655,7 +1736,7 @@ void TrafficManager::_Inject()
                        
                         // Potentially generate packets for any (input,class)
                         // that is currently empty
-                        if (watch || (_routers_to_watch.count(i) > 0))
+                        if (watch || (_routers_to_watch.Contains(i)))
                         {
                             *gWatchOut << GetSimTime() << " | "
                                 << "node" << i << " | "
@@ -1670,10 +1751,10 @@ void TrafficManager::_Inject()
                         if (watch && f->head && f->mflag)
                         {
                             *gWatchOut << "Pid " << f->pid << " Destinations are: " << endl;
-                            for (int i = 0; i < f->mdest.first.size(); i++) {
-                                *gWatchOut << f->mdest.first[i] << " ";
+                            for (int d = f->GetMdest().first.First(); d >= 0; d = f->GetMdest().first.Next(d)) {
+                                *gWatchOut << d << " ";
                             }
-                            *gWatchOut << "num dests " << f->mdest.first.size() << " simtime " << GetSimTime() << " source " << i << endl;
+                            *gWatchOut << "num dests " << f->GetMdest().first.Size() << " simtime " << GetSimTime() << " source " << i << endl;
                         }
                         
 
@@ -1689,8 +1770,85 @@ void TrafficManager::_Inject()
              }
             }
         }
+
+    _ScheduleEndpoints();
  }
 
+void TrafficManager::_WakeEndpoint(int endpoint, int time)
+{
+    if (time < _endpoint_wake[endpoint])
+    {
+        _endpoint_wake[endpoint] = time;
+        _wakeups.push(make_pair(time, endpoint));
+    }
+}
+
+void TrafficManager::_ResetEndpoints()
+{
+    _endpoint_wake.assign(_endpoint_nodes.size(), numeric_limits<int>::max());
+    _endpoint_run.assign(_endpoint_nodes.size(), _time - 1);
+    _endpoint_done.assign(_endpoint_nodes.size(), false);
+    _wakeups = priority_queue<pair<int, int>, vector<pair<int, int> >, greater<pair<int, int> > >();
+    for (size_t e = 0; e < _endpoint_nodes.size(); ++e)
+    {
+        _WakeEndpoint(e, _time);
+    }
+    _cores_done = 0;
+}
+
+void TrafficManager::_WakeEndpoints()
+{
+    _woken.clear();
+    _woken_nodes.clear();
+    while (!_wakeups.empty() && (_wakeups.top().first <= _time))
+    {
+        int const e = _wakeups.top().second;
+        // entries superseded by an earlier wake-up are left in the queue
+        if (_wakeups.top().first == _endpoint_wake[e])
+        {
+            _endpoint_wake[e] = numeric_limits<int>::max();
+            _woken.push_back(e);
+            _woken_nodes.insert(_woken_nodes.end(), _endpoint_nodes[e].begin(), _endpoint_nodes[e].end());
+            int const d = _endpoint_ddr[e];
+            if (d >= 0)
+            {
+                _ddr[d]->fast_forward(_time - _endpoint_run[e] - 1);
+            }
+            _endpoint_run[e] = _time;
+        }
+        _wakeups.pop();
+    }
+    // endpoints act in node order, as they draw from the same random stream
+    sort(_woken_nodes.begin(), _woken_nodes.end());
+}
+
+void TrafficManager::_ScheduleEndpoints()
+{
+    for (int e : _woken)
+    {
+        int const d = _endpoint_ddr[e];
+        if (d >= 0)
+        {
+            _WakeEndpoint(e, _ddr[d]->next_event(_time + 1));
+            continue;
+        }
+        int const n = _endpoint_nodes[e][0];
+        bool empty = false;
+        for (int c = 0; c < _classes; ++c)
+        {
+            empty |= _partial_packets[n][c].empty();
+        }
+        _WakeEndpoint(e, _core[n]->next_event(_time + 1, empty));
+        vector<int> const& end = _core[n]->_check_end();
+        if (end[0] && !_endpoint_done[e])
+        {
+            _endpoint_done[e] = true;
+            ++_cores_done;
+            _wl_end_time = max(_wl_end_time, end[1]);
+        }
+    }
+}
+
 
 void TrafficManager::_Step()
 {
@@ -1719,11 +1877,11 @@ void TrafficManager::_Step()
                         << ", transfer_id = " << x.second->transfer_id
                         << ", from_ddr =" << x.second->from_ddr
                         << ", size =" << x.second->size
-                        << " layer_name =" << x.second->layer_name << "\n"
-                        << " num dests " << x.second->mdest.first.size() << " simtime " << GetSimTime()
+                        << " layer_name =" << Flit::LayerName(x.second->layer) << "\n"
+                        << " num dests " << x.second->GetMdest().first.Size() << " simtime " << GetSimTime()
                         << " multi Destinations are: ";
-                    for (int i = 0; i < x.second->mdest.first.size(); i++) {
-                        *gWatchOut << x.second->mdest.first[i] << " ";
+                    for (int d = x.second->GetMdest().first.First(); d >= 0; d = x.second->GetMdest().first.Next(d)) {
+                        *gWatchOut << d << " ";
                     }
                     *gWatchOut << "\n";
                     *gWatchOut << "\n";
@@ -1737,7 +1895,6 @@ void TrafficManager::_Step()
     //if (flush == true && _total_in_flight_flits[0].empty()) {
     //    cout << "deadlock over";
     //}
-    vector<map<int, Flit *> > flits(_subnets);
 
     for (int subnet = 0; subnet < _subnets; ++subnet)
     {
@@ -1746,7 +1903,7 @@ void TrafficManager::_Step()
             Flit *const f = _net[subnet]->ReadFlit(n);
             if (f)
             {
-                if (f->watch || (_routers_to_watch.count(n)>0))
+                if (f->watch || (_routers_to_watch.Contains(n)))
                 {
                     *gWatchOut << GetSimTime() << " | "
                                << "node" << n << " | "
@@ -1755,7 +1912,7 @@ void TrafficManager::_Step()
                                << " from VC " << f->vc
                                << "." << endl;
                 }
-                flits[subnet].insert(make_pair(n, f));
+                _ejected[subnet].push_back(make_pair(n, f));
                 if ((_sim_state == warming_up) || (_sim_state == running))
                 {
                     ++_accepted_flits[f->cl][n];
@@ -1770,9 +1927,8 @@ void TrafficManager::_Step()
             if (c)
             {
 #ifdef TRACK_FLOWS
-                for (set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter)
+                for (int vc = c->FirstVC(); vc >= 0; vc = c->NextVC(vc))
                 {
-                    int const vc = *iter;
                     assert(!_outstanding_classes[n][subnet][vc].empty());
                     int cl = _outstanding_classes[n][subnet][vc].front();
                     _outstanding_classes[n][subnet][vc].pop();
@@ -1855,7 +2011,7 @@ void TrafficManager::_Step()
 
                     OutputSet route_set;
                     _rf(NULL, cf, -1, &route_set, true);
-                    set<OutputSet::sSetElement> const &os = route_set.GetSet();
+                    OutputSet const &os = route_set.GetSet();
                     assert(os.size() == 1);
                     OutputSet::sSetElement const &se = *os.begin();
                     assert(se.output_port == -1);
@@ -1879,14 +2035,14 @@ void TrafficManager::_Step()
                         _rf(router, cf, in_channel, &cf->la_route_set, false);
                         cf->vc = -1;
 
-                        if (cf->watch||(_routers_to_watch.count(n) > 0))
+                        if (cf->watch||(_routers_to_watch.Contains(n)))
                         {
                             *gWatchOut << GetSimTime() << " | "
                                        << "node" << n << " | "
                                        << "Generating lookahead routing info for flit " << cf->id
                                        << " (NOQ)." << endl;
                         }
-                        set<OutputSet::sSetElement> const sl = cf->la_route_set.GetSet();
+                        OutputSet const &sl = cf->la_route_set.GetSet();
                         assert(sl.size() == 1);
                         int next_output = sl.begin()->output_port;
                         vc_count /= router->NumOutputs();
@@ -1896,7 +2052,7 @@ void TrafficManager::_Step()
                         assert(vc_end >= se.vc_start && vc_end <= se.vc_end);
                         assert(vc_start <= vc_end);
                     }
-                    if (cf->watch || (_routers_to_watch.count(n) > 0))
+                    if (cf->watch || (_routers_to_watch.Contains(n)))
                     {
                         *gWatchOut << GetSimTime() << " | " << FullName() << " | "
                                    << "Finding output VC for flit " << cf->id
@@ -1915,7 +2071,7 @@ void TrafficManager::_Step()
                         assert((vc >= vc_start) && (vc <= vc_end));
                         if (!dest_buf->IsAvailableFor(vc))
                         {
-                            if (cf->watch || (_routers_to_watch.count(n) > 0))
+                            if (cf->watch || (_routers_to_watch.Contains(n)))
                             {
                                 *gWatchOut << GetSimTime() << " | " << FullName() << " | "
                                            << "  Output VC " << vc << " is busy." << endl;
@@ -1926,7 +2082,7 @@ void TrafficManager::_Step()
                         {
                             if (dest_buf->IsFullFor(vc))
                             {
-                                if (cf->watch || (_routers_to_watch.count(n) > 0))
+                                if (cf->watch || (_routers_to_watch.Contains(n)))
                                 {
                                     *gWatchOut << GetSimTime() << " | " << FullName() << " | "
                                                << "  Output VC " << vc << " is full." << endl;
@@ -1935,7 +2091,7 @@ void TrafficManager::_Step()
                             }
                             else
                             {
-                                if (cf->watch || (_routers_to_watch.count(n) > 0))
+                                if (cf->watch || (_routers_to_watch.Contains(n)))
                                 {
                                     *gWatchOut << GetSimTime() << " | " << FullName() << " | "
                                                << "  Selected output VC " << vc << "." << endl;
@@ -1950,7 +2106,7 @@ void TrafficManager::_Step()
 
                 if (cf->vc == -1)
                 {
-                    if (cf->watch || (_routers_to_watch.count(n) > 0))
+                    if (cf->watch || (_routers_to_watch.Contains(n)))
                     {
                         *gWatchOut << GetSimTime() << " | " << FullName() << " | "
                                    << "No output VC found for flit " << cf->id
@@ -1962,7 +2118,7 @@ void TrafficManager::_Step()
                 {
                     if (dest_buf->IsFullFor(cf->vc))
                     {
-                        if (cf->watch || (_routers_to_watch.count(n) > 0))
+                        if (cf->watch || (_routers_to_watch.Contains(n)))
                         {
                             *gWatchOut << GetSimTime() << " | " << FullName() << " | "
                                        << "Selected output VC " << cf->vc
@@ -1997,7 +2153,7 @@ void TrafficManager::_Step()
                             assert(router);
                             int in_channel = inject->GetSinkPort();
                             _rf(router, f, in_channel, &f->la_route_set, false);
-                            if (f->watch || (_routers_to_watch.count(n) > 0))
+                            if (f->watch || (_routers_to_watch.Contains(n)))
                             {
                                 *gWatchOut << GetSimTime() << " | "
                                            << "node" << n << " | "
@@ -2005,7 +2161,7 @@ void TrafficManager::_Step()
                                            << "." << endl;
                             }
                         }
-                        else if (f->watch || (_routers_to_watch.count(n) > 0))
+                        else if (f->watch || (_routers_to_watch.Contains(n)))
                         {
                             *gWatchOut << GetSimTime() << " | "
                                        << "node" << n << " | "
@@ -2025,6 +2181,10 @@ void TrafficManager::_Step()
                 _last_class[n][subnet] = c;
 
                 _partial_packets[n][c].pop_front();
+                if (_partial_packets[n][c].empty() && (_endpoint[n] >= 0))
+                {
+                    _WakeEndpoint(_endpoint[n], _time + 1);
+                }
 
 #ifdef TRACK_FLOWS
                 ++_outstanding_credits[c][subnet][n];
@@ -2039,7 +2199,7 @@ void TrafficManager::_Step()
                     assert(f->pri >= 0);
                 }
 
-                if (f->watch || (_routers_to_watch.count(n) > 0))
+                if (f->watch || (_routers_to_watch.Contains(n)))
                 {
                     *gWatchOut << GetSimTime() << " | "
                                << "node" << n << " | "
@@ -2080,38 +2240,36 @@ void TrafficManager::_Step()
     // Return Credit for the Received flits so we assume
     for (int subnet = 0; subnet < _subnets; ++subnet)
     {
-        for (int n = 0; n < _nodes; ++n)
-        {  
-            map<int, Flit *>::const_iterator iter = flits[subnet].find(n);
-            if (iter != flits[subnet].end())
-            {
-                Flit* const f = iter->second;
+        for (auto const& ej : _ejected[subnet])
+        {
+            int const n = ej.first;
+            Flit* const f = ej.second;
 
-                f->atime = _time;
-                if (f->watch || (_routers_to_watch.count(n) > 0))
-                {
-                    *gWatchOut << GetSimTime() << " | "
-                        << "node" << n << " | "
-                        << "Injecting credit for VC " << f->vc
-                        << " into subnet " << subnet
-                        << "." << endl;
-                }
-                Credit* const c = Credit::New();
-                c->vc.insert(f->vc);
-                _net[subnet]->WriteCredit(c, n);
+            f->atime = _time;
+            if (f->watch || (_routers_to_watch.Contains(n)))
+            {
+                *gWatchOut << GetSimTime() << " | "
+                    << "node" << n << " | "
+                    << "Injecting credit for VC " << f->vc
+                    << " into subnet " << subnet
+                    << "." << endl;
+            }
+            Credit* const c = Credit::New();
+            c->AddVC(f->vc);
+            _net[subnet]->WriteCredit(c, n);
 
 #ifdef TRACK_FLOWS
-                ++_ejected_flits[f->cl][n];
+            ++_ejected_flits[f->cl][n];
 #endif          
-                if ((core_id.count(n) && f->tail)) {
-                    _core[n]->receive_message(f);
-                }
-                else if (ddr_id.count(n) > 0 && f->tail) {
-                    _ddr[ddr_id[n]]->receive_message(f);
-                }
-                _RetireFlit(f, n);
-            
+            if ((core_id.count(n) && f->tail)) {
+                _core[n]->receive_message(f);
+                _WakeEndpoint(_endpoint[n], _time + 1);
+            }
+            else if (ddr_id.count(n) > 0 && f->tail) {
+                _ddr[ddr_id[n]]->receive_message(f);
+                _WakeEndpoint(_endpoint[n], _time + 1);
             }
+            _RetireFlit(f, n);
         }
         for (int m = 0; m < _nhubs; m++)
         {
@@ -2123,7 +2281,7 @@ void TrafficManager::_Step()
             }
             _hub[subnet][m]->_dropped_flits.clear();
         }
-        flits[subnet].clear();
+        _ejected[subnet].clear();
         _net[subnet]->Evaluate();
         _net[subnet]->WriteOutputs();
     }
@@ -2149,6 +2307,73 @@ void TrafficManager::_Step()
     //End of Label : Token Passing
 }
 
+void TrafficManager::_FastForward()
+{
+    for (int c = 0; c < _classes; ++c)
+    {
+        if (!_total_in_flight_flits[c].empty())
+        {
+            return;
+        }
+    }
+    if (Credit::OutStanding() != 0)
+    {
+        return;
+    }
+
+    // Run() checks for completion every 300 cycles and _Step() reports
+    // progress every 10000, so never jump past either boundary.
+    int target = min((_time / 300 + 1) * 300, (_time / 10000 + 1) * 10000);
+    while (!_wakeups.empty() && (_wakeups.top().first != _endpoint_wake[_wakeups.top().second]))
+    {
+        _wakeups.pop();
+    }
+    if (!_wakeups.empty())
+    {
+        target = min(target, _wakeups.top().first);
+    }
+    if (target <= _time)
+    {
+        return;
+    }
+    for (int subnet = 0; subnet < _subnets; ++subnet)
+    {
+        if (!_net[subnet]->IsQuiescent())
+        {
+            return;
+        }
+    }
+
+    // sleeping DDRs catch up on the skipped cycles when they next run
+    int const skipped = target - _time;
+    if (token_ring.size() && !token_hold)
+    {
+        std::rotate(token_ring.begin(), token_ring.begin() + skipped % token_ring.size(), token_ring.end());
+    }
+    _time = target;
+    if (_time % 10000 == 0)
+    {
+        cout << "time = " << _time << endl;
+    }
+}
+
+void TrafficManager::_TrimPools()
+{
+    for (int c = 0; c < _classes; ++c)
+    {
+        if (!_total_in_flight_flits[c].empty())
+        {
+            return;
+        }
+    }
+    if (Credit::OutStanding() != 0)
+    {
+        return;
+    }
+    Flit::TrimPool();
+    Credit::TrimPool();
+}
+
 bool TrafficManager::_PacketsOutstanding() const
 {
     for (int c = 0; c < _classes; ++c)
@@ -2547,6 +2772,7 @@ bool TrafficManager::Run()
     {
         stop = false;
         _time = 0;
+        _ResetEndpoints();
         //Bransan uncertain if needs change or no
         //remove any pending request from the previous simulations
         _requestsOutstanding.assign(_nodes, 0);
@@ -2583,19 +2809,18 @@ bool TrafficManager::Run()
         while (!stop)
         {
             _Step();
+            if (_fast_forward)
+            {
+                _FastForward();
+            }
 //            cout << _time << "\n";
             if (_time % 300 == 0) {
-                stop = true;
-                for (auto p : core_id) {
-                    vector<int> temp = _core[p]->_check_end();
-                    if (temp[0]) {
-                        ojson[to_string(p)] = _core[p]->get_json()[to_string(p)];
-                    }
-                    stop = stop && temp[0];
-                    if (temp[1] > _wl_end_time) {
-                        _wl_end_time = temp[1];
-                    }
+                if (_pool_trim)
+                {
+                    _TrimPools();
                 }
+                _paint.Flush();
+                stop = (_cores_done == (int)core_id.size());
             }
         }
         UpdateStats();
@@ -2643,13 +2868,22 @@ bool TrafficManager::Run()
         //the power script depend on it
         cout << "Workload taken " << _wl_end_time << " cycles" << endl;
         cout << "Time taken is " << _time << " cycles" << endl;
-        ojson["attribute"]["end"] = _time;
-        ojson["attribute"]["core_num"] = dim_x * dim_y;
-
+        _paint.Close(_time, dim_x * dim_y, vector<int>(core_id.begin(), core_id.end()));
+        if (_paint_json)
+        {
+            string paint_error;
+            if (!PaintWriter::Convert(route + "_paint.jsonl", route + "_paint.json", paint_error))
+            {
+                Error("Cannot write workload timeline: " + paint_error);
+            }
+        }
 
-        string ofile =  route +  "_paint.json";
-        std::ofstream file(ofile);
-        file << ojson;
+        if (_pool_trim)
+        {
+            _TrimPools();
+        }
+        Flit::DisplayPool(cout);
+        Credit::DisplayPool(cout);
 
         if (_stats_out)
         {
@@ -31,6 +31,7 @@
 #include <list>
 #include <map>
 #include <set>
+#include <queue>
 #include <cassert>
 
 #include "module.hpp"
@@ -46,6 +47,7 @@
 #include "core.hpp"
 #include "ddr.hpp"
 #include "json.hpp"
+#include "watch_list.hpp"
 
 //register the requests to a node
 class PacketReplyInfo;
@@ -70,7 +72,6 @@ protected:
   vector<int> ddr_routers;
   //Bransan added num of hubs
   int _nhubs;
-  nlohmann::json ojson;
   string net_name;
   string route;
 
@@ -85,6 +86,12 @@ protected:
   vector<Network *> _net;
   vector<vector<Router *> > _router;
   vector<vector<Hub *> > _hub; //Bransan added vector for hubs
+  // compiled schedule the cores and DDRs read from
+  WorkloadIR _ir;
+  // workload timeline, streamed to route + "_paint.jsonl"
+  PaintWriter _paint;
+  // rebuild route + "_paint.json" from the stream at the end of the run
+  bool _paint_json;
   vector<Core*> _core;
   unordered_set<int>core_id;
   vector<DDR*> _ddr;
@@ -142,6 +149,15 @@ protected:
   vector<vector<bool> > _qdrained;
   // vector<vector<list<Flit *> > > _partial_packets;
 
+  // per-cycle scratch, kept across cycles so that _Step/_Inject do not
+  // allocate: flits ejected this cycle per subnet (in node order), DDR
+  // routers with an empty injection queue and the new flits of one
+  // node/class
+  vector<vector<pair<int, Flit *> > > _ejected;
+  vector<vector<int> > _ddr_empty_routers;
+  vector<bool> _ddr_empty;
+  vector<Flit *> _new_flits;
+
   // vector<map<int, Flit *> > _total_in_flight_flits;
   // vector<map<int, Flit *> > _measured_in_flight_flits;
   
@@ -149,6 +165,32 @@ protected:
   vector<map<int, Flit *> > _retired_packets;
   bool _empty_network;
 
+  // skip cycles in which neither the network nor any endpoint has work
+  bool _fast_forward;
+
+  // Cores and DDRs are endpoints that _Inject only runs in cycles where
+  // they can act: at the wake-up time their next_event reports (tile end,
+  // DDR drain completion, ...), or in the cycle after a message arrived
+  // or their injection queue ran empty. A DDR is one endpoint over all of
+  // its routers and catches up on the cycles it slept before it runs.
+  vector<int> _endpoint; // node -> endpoint, -1 for plain routers
+  vector<vector<int> > _endpoint_nodes; // endpoint -> its nodes, ascending
+  vector<int> _endpoint_ddr; // endpoint -> DDR, -1 for a core
+  vector<int> _endpoint_wake; // endpoint -> cycle of its next run
+  vector<int> _endpoint_run; // endpoint -> last cycle it ran
+  vector<bool> _endpoint_done; // endpoint -> core sent all its data
+  priority_queue<pair<int, int>, vector<pair<int, int> >, greater<pair<int, int> > > _wakeups;
+  vector<int> _woken; // endpoints run this cycle
+  vector<int> _woken_nodes; // their nodes, ascending
+  // cores that sent all their data, counted as they finish
+  int _cores_done;
+
+  // steps routers and channels in parallel when sim_threads > 1
+  ThreadPool * _pool;
+
+  // give idle flit/credit slabs back whenever the network is empty
+  bool _pool_trim;
+
   bool _hold_switch_for_packet;
 
   // ============ physical sub-networks ==========
@@ -268,7 +310,7 @@ protected:
 
   set<int> _flits_to_watch;
   set<int> _packets_to_watch;
-  set<int> _routers_to_watch;
+  WatchList _routers_to_watch;
   set<int> _transfers_to_watch;
   set<int> _cores_to_watch;
   bool _watch_deadlock;
@@ -303,6 +345,12 @@ protected:
 
   void _Inject();
   void _Step( );
+  void _FastForward( );
+  void _WakeEndpoint( int endpoint, int time );
+  void _ResetEndpoints( );
+  void _WakeEndpoints( );
+  void _ScheduleEndpoints( );
+  void _TrimPools( );
 
   bool _PacketsOutstanding( ) const;
   
@@ -340,7 +388,7 @@ public:
   int _num_mcast_dests;
   int rand_dest;
   bool flush;
-  vector<int> _GetMcastDests(int source);
+  NodeSet _GetMcastDests(int source);
 
   static TrafficManager * New(Configuration const & config, 
 			      vector<Network *> const & net);
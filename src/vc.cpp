@@ -56,7 +56,7 @@ VC::VC(const Configuration &config, int outputs,
   _route_set = _lookahead_routing ? NULL : new OutputSet();
   
   // assert(outputs == 5 || outputs == 6);
-  // mcast_table.resize(outputs);
+  mcast_table.Resize(outputs);
   
   string priority = config.GetStr("priority");
   if (priority == "local_age")
@@ -90,12 +90,9 @@ VC::~VC()
     delete _route_set;
   }
 }
-void VC::addFlitMCastEntry(int dest, int outport, bool wflag)
+void VC::addFlitMCastEntry(const NodeSet & dests, int outport, bool wflag)
 {
-  if(wflag)
-    mcast_table[outport].second.push_back(dest);
-  else
-    mcast_table[outport].first.push_back(dest);
+  mcast_table.Add(outport, dests, wflag);
 
 }
 
@@ -175,18 +172,18 @@ const OutputSet *VC::GetRouteSet() const
   return _route_set;
 }
 
-vector <int> VC::GetMulticastOutpair() 
+const vector <int> & VC::GetMulticastOutpair() const
 {
   return _MOutputandVC;
 }
 
-map<int, pair<vector<int>, vector<int> > > VC::GetMcastTable()
+const McastTable & VC::GetMcastTable() const
 {
   return mcast_table;
 }
 
 void VC::EraseMcastTable( ){
-  mcast_table.clear();
+  mcast_table.Clear();
 }
 
 void VC::EraseOutpair( ){
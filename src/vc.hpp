@@ -30,6 +30,7 @@
 
 #include <deque>
 #include "flit.hpp"
+#include "mcast_table.hpp"
 #include "outputset.hpp"
 #include "routefunc.hpp"
 #include "config_utils.hpp"
@@ -83,15 +84,15 @@ public:
     return _buffer.empty() ? NULL : _buffer.front();
   }
   //Bransan Added 
-  map< int , pair< vector<int> , vector <int> > > mcast_table;
+  McastTable mcast_table;
   vector <int> _MOutputandVC;
   void PushMOutputandVC(int outputandvc);
-  void addFlitMCastEntry(int dest, int outport, bool wflag);
-  map<int, pair<vector<int>, vector<int> > > GetMcastTable();
+  void addFlitMCastEntry(const NodeSet & dests, int outport, bool wflag);
+  const McastTable & GetMcastTable() const;
   void EraseMcastTable( );
   void EraseOutpair( );
 
-  vector <int> GetMulticastOutpair();
+  const vector <int> & GetMulticastOutpair() const;
   Flit *RemoveFlit( );
   int _mcCount;
 
@@ -0,0 +1,80 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*watch_list.hpp
+ *
+ *Ids selected by one of the watch_* options (routers, cores, transfers),
+ *kept as a flat bit vector so that the per-flit "is this watched" checks
+ *are an index instead of a set lookup.
+ *
+ *Building with -DNO_WATCH compiles every check down to false.
+ */
+
+#ifndef _WATCH_LIST_HPP_
+#define _WATCH_LIST_HPP_
+
+#include <vector>
+
+using namespace std;
+
+#ifdef NO_WATCH
+const bool gWatchBuild = false;
+#else
+const bool gWatchBuild = true;
+#endif
+
+class WatchList {
+
+public:
+  WatchList( ) : _any(false) {}
+
+  void Insert( int id )
+  {
+    if ( id < 0 ) {
+      return;
+    }
+    if ( id >= (int)_bits.size( ) ) {
+      _bits.resize( id + 1, false );
+    }
+    _bits[id] = true;
+    _any = true;
+  }
+
+  bool Contains( int id ) const
+  {
+    return gWatchBuild && _any &&
+      ( id >= 0 ) && ( id < (int)_bits.size( ) ) && _bits[id];
+  }
+
+  bool Empty( ) const { return !_any; }
+
+private:
+  vector<bool> _bits;
+  bool _any;
+};
+
+#endif
@@ -0,0 +1,579 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*workload_ir.cpp
+ *
+ *Streams the JSON workload IR into the flat records of WorkloadIR.
+ */
+
+#include "booksim.hpp"
+#include "workload_ir.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Builds a DOM for one record at a time: a workload (depth 3, inside the
+// array of a core section) or a DDR entry (depth 4, inside "in"/"out" of
+// the "-1" section). Everything above the records is tracked with the
+// section/list keys only and everything else is skipped.
+class IRSaxReader : public nlohmann::json_sax<nlohmann::json> {
+
+public:
+  IRSaxReader( WorkloadIR & ir ) : _ir( ir ), _depth( 0 ), _core( -1 ) { }
+
+  bool null( ) { return _Value( nlohmann::json( ) ); }
+  bool boolean( bool val ) { return _Value( val ); }
+  bool number_integer( number_integer_t val ) { return _Value( val ); }
+  bool number_unsigned( number_unsigned_t val ) { return _Value( val ); }
+  bool number_float( number_float_t val, const string_t & ) { return _Value( val ); }
+  bool string( string_t & val ) { return _Value( val ); }
+  bool binary( binary_t & ) { return _Value( nlohmann::json( ) ); }
+
+  bool key( string_t & val )
+  {
+    if ( !_stack.empty( ) ) {
+      _key = val;
+    } else if ( _depth == 1 ) {
+      _section = val;
+    } else if ( _depth == 2 ) {
+      _list = val;
+    }
+    return true;
+  }
+
+  bool start_object( std::size_t )
+  {
+    ++_depth;
+    if ( !_stack.empty( ) ) {
+      _stack.push_back( _Add( nlohmann::json::object( ) ) );
+    } else if ( _depth == _RecordDepth( ) ) {
+      _record = nlohmann::json::object( );
+      _stack.push_back( &_record );
+    }
+    return true;
+  }
+
+  bool end_object( )
+  {
+    if ( !_stack.empty( ) ) {
+      _stack.pop_back( );
+      if ( _stack.empty( ) ) {
+	if ( _core >= 0 ) {
+	  _ir._CompileWorkload( _record );
+	} else if ( _list == "in" ) {
+	  _ir._CompileDdrIn( _record );
+	} else if ( _list == "out" ) {
+	  _ir._CompileDdrOut( _record );
+	}
+	_record = nlohmann::json( );
+      }
+    }
+    --_depth;
+    return true;
+  }
+
+  bool start_array( std::size_t )
+  {
+    ++_depth;
+    if ( !_stack.empty( ) ) {
+      _stack.push_back( _Add( nlohmann::json::array( ) ) );
+    } else if ( ( _depth == 2 ) && _IsCore( _section ) ) {
+      _core = atoi( _section.c_str( ) );
+      _ir._BeginCore( _core );
+    }
+    return true;
+  }
+
+  bool end_array( )
+  {
+    if ( !_stack.empty( ) ) {
+      _stack.pop_back( );
+    } else if ( ( _depth == 2 ) && ( _core >= 0 ) ) {
+      _ir._EndCore( _core );
+      _core = -1;
+    }
+    --_depth;
+    return true;
+  }
+
+  bool parse_error( std::size_t, const std::string &, const nlohmann::detail::exception & ex )
+  {
+    _error = ex.what( );
+    return false;
+  }
+
+  const std::string & Error( ) const { return _error; }
+
+private:
+  WorkloadIR & _ir;
+  int _depth;
+  int _core;
+  std::string _section;
+  std::string _list;
+  std::string _key;
+  std::string _error;
+
+  nlohmann::json _record;
+  vector<nlohmann::json *> _stack;
+
+  // core sections are keyed by a non-negative id
+  static bool _IsCore( const std::string & key )
+  {
+    if ( key.empty( ) ) {
+      return false;
+    }
+    for ( size_t i = 0; i < key.size( ); ++i ) {
+      if ( ( key[i] < '0' ) || ( key[i] > '9' ) ) {
+	return false;
+      }
+    }
+    return true;
+  }
+
+  int _RecordDepth( ) const
+  {
+    if ( _core >= 0 ) {
+      return 3;
+    }
+    return ( ( _section == "-1" ) && ( _depth > 2 ) ) ? 4 : -1;
+  }
+
+  nlohmann::json * _Add( nlohmann::json && val )
+  {
+    nlohmann::json & parent = *_stack.back( );
+    if ( parent.is_array( ) ) {
+      parent.push_back( std::move( val ) );
+      return &parent.back( );
+    }
+    nlohmann::json & slot = parent[_key];
+    slot = std::move( val );
+    return &slot;
+  }
+
+  bool _Value( nlohmann::json && val )
+  {
+    if ( !_stack.empty( ) ) {
+      _Add( std::move( val ) );
+    }
+    return true;
+  }
+};
+
+// Binary IR: a fixed header followed by one section per record array.
+// Sections are 8-byte aligned and hold the records exactly as they are
+// laid out in memory, so a mapped file is used without any conversion.
+// Layer names are a table of NumLayers + 1 offsets into the name chars.
+namespace {
+
+const char kMagic[8] = { 'B', 'S', 'I', 'R', 'B', 'I', 'N', '\0' };
+const uint32_t kVersion = 1;
+const uint32_t kByteOrder = 0x01020304;
+
+enum { SEC_CORES, SEC_WORKLOADS, SEC_OFMAPS, SEC_DESTS, SEC_BUFFERS,
+       SEC_SOURCES, SEC_TRANSFERS, SEC_DDR_INS, SEC_DDR_OUTS, SEC_DDR_IDS,
+       SEC_LAYER_OFFSETS, SEC_LAYER_CHARS, NUM_SECTIONS };
+
+struct Section {
+  uint64_t offset;
+  uint64_t count;
+  uint64_t record;	// size of one record, checked on load
+};
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t num_cores;
+  uint32_t num_layers;
+  Section sections[NUM_SECTIONS];
+};
+
+inline uint64_t Align( uint64_t offset )
+{
+  return ( offset + 7 ) & ~uint64_t( 7 );
+}
+
+}
+
+WorkloadIR::WorkloadIR( ) : _map( 0 ), _map_size( 0 )
+{
+}
+
+WorkloadIR::~WorkloadIR( )
+{
+  Clear( );
+}
+
+void WorkloadIR::Clear( )
+{
+  _cores.clear( );
+  _workloads.clear( );
+  _ofmaps.clear( );
+  _dests.clear( );
+  _buffers.clear( );
+  _sources.clear( );
+  _transfers.clear( );
+  _ddr_ins.clear( );
+  _ddr_outs.clear( );
+  _ddr_ids.clear( );
+  _layer_names.clear( );
+  _flit_layers.clear( );
+  _layer_ids.clear( );
+  if ( _map ) {
+    munmap( _map, _map_size );
+    _map = 0;
+    _map_size = 0;
+  }
+}
+
+bool WorkloadIR::Load( const string & file, string & error )
+{
+  Clear( );
+  ifstream in( file.c_str( ), ios::binary );
+  if ( !in ) {
+    error = "cannot open " + file;
+    return false;
+  }
+  char magic[sizeof( kMagic )];
+  if ( in.read( magic, sizeof( magic ) ) && !memcmp( magic, kMagic, sizeof( kMagic ) ) ) {
+    in.close( );
+    return _Map( file, error );
+  }
+  in.clear( );
+  in.seekg( 0 );
+  return _Parse( in, error );
+}
+
+bool WorkloadIR::_Parse( istream & in, string & error )
+{
+  IRSaxReader reader( *this );
+  if ( !nlohmann::json::sax_parse( in, &reader ) ) {
+    error = reader.Error( );
+    Clear( );
+    return false;
+  }
+  return true;
+}
+
+bool WorkloadIR::_Map( const string & file, string & error )
+{
+  int const fd = open( file.c_str( ), O_RDONLY );
+  if ( fd < 0 ) {
+    error = "cannot open " + file;
+    return false;
+  }
+  struct stat st;
+  if ( ( fstat( fd, &st ) < 0 ) || ( size_t( st.st_size ) < sizeof( Header ) ) ) {
+    close( fd );
+    error = file + ": truncated binary IR";
+    return false;
+  }
+  void * const map = mmap( 0, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+  close( fd );
+  if ( map == MAP_FAILED ) {
+    error = "cannot map " + file;
+    return false;
+  }
+  _map = map;
+  _map_size = st.st_size;
+
+  const char * const base = static_cast<const char *>( map );
+  const Header & h = *reinterpret_cast<const Header *>( base );
+  if ( h.byte_order != kByteOrder ) {
+    error = file + ": binary IR written with a different byte order";
+  } else if ( h.version != kVersion ) {
+    error = file + ": unsupported binary IR version";
+  }
+  static const size_t records[NUM_SECTIONS] = {
+    sizeof( CoreRange ), sizeof( Workload ), sizeof( Ofmap ), sizeof( Dest ),
+    sizeof( Buffer ), sizeof( Source ), sizeof( int ), sizeof( DdrIn ),
+    sizeof( DdrOut ), sizeof( int ), sizeof( uint64_t ), sizeof( char )
+  };
+  for ( int s = 0; error.empty( ) && ( s < NUM_SECTIONS ); ++s ) {
+    const Section & sec = h.sections[s];
+    if ( ( sec.record != records[s] ) || ( sec.offset % 8 ) ||
+	 ( sec.offset > _map_size ) ||
+	 ( sec.count > ( _map_size - sec.offset ) / sec.record ) ) {
+      error = file + ": corrupt binary IR";
+    }
+  }
+  if ( error.empty( ) &&
+       ( ( h.sections[SEC_CORES].count != h.num_cores ) ||
+	 ( h.sections[SEC_LAYER_OFFSETS].count != uint64_t( h.num_layers ) + 1 ) ) ) {
+    error = file + ": corrupt binary IR";
+  }
+  if ( !error.empty( ) ) {
+    Clear( );
+    return false;
+  }
+
+#define SECTION( s, T ) \
+  reinterpret_cast<const T *>( base + h.sections[s].offset ), h.sections[s].count
+  _workloads.view( SECTION( SEC_WORKLOADS, Workload ) );
+  _ofmaps.view( SECTION( SEC_OFMAPS, Ofmap ) );
+  _dests.view( SECTION( SEC_DESTS, Dest ) );
+  _buffers.view( SECTION( SEC_BUFFERS, Buffer ) );
+  _sources.view( SECTION( SEC_SOURCES, Source ) );
+  _transfers.view( SECTION( SEC_TRANSFERS, int ) );
+  _ddr_ins.view( SECTION( SEC_DDR_INS, DdrIn ) );
+  _ddr_outs.view( SECTION( SEC_DDR_OUTS, DdrOut ) );
+  _ddr_ids.view( SECTION( SEC_DDR_IDS, int ) );
+#undef SECTION
+
+  // the small per-core and per-layer tables are copied; the ranges they
+  // hold are checked so that Workloads( ) never leaves the mapping
+  const CoreRange * cores = reinterpret_cast<const CoreRange *>( base + h.sections[SEC_CORES].offset );
+  _cores.assign( cores, cores + h.num_cores );
+  for ( int c = 0; c < NumCores( ); ++c ) {
+    if ( ( _cores[c].begin < 0 ) || ( _cores[c].begin > _cores[c].end ) ||
+	 ( size_t( _cores[c].end ) > _workloads.size( ) ) ) {
+      error = file + ": corrupt binary IR";
+      Clear( );
+      return false;
+    }
+  }
+  const uint64_t * offsets = reinterpret_cast<const uint64_t *>( base + h.sections[SEC_LAYER_OFFSETS].offset );
+  const char * chars = base + h.sections[SEC_LAYER_CHARS].offset;
+  for ( uint32_t l = 0; l < h.num_layers; ++l ) {
+    if ( ( offsets[l] > offsets[l+1] ) || ( offsets[l+1] > h.sections[SEC_LAYER_CHARS].count ) ) {
+      error = file + ": corrupt binary IR";
+      Clear( );
+      return false;
+    }
+    _InternLayer( string( chars + offsets[l], chars + offsets[l+1] ) );
+  }
+  return true;
+}
+
+bool WorkloadIR::Save( const string & file, string & error ) const
+{
+  vector<uint64_t> offsets( 1, 0 );
+  string chars;
+  for ( int l = 0; l < NumLayers( ); ++l ) {
+    chars += _layer_names[l];
+    offsets.push_back( chars.size( ) );
+  }
+
+  Header h;
+  memset( &h, 0, sizeof( h ) );
+  memcpy( h.magic, kMagic, sizeof( kMagic ) );
+  h.version = kVersion;
+  h.byte_order = kByteOrder;
+  h.num_cores = NumCores( );
+  h.num_layers = NumLayers( );
+
+  const void * data[NUM_SECTIONS];
+  uint64_t offset = Align( sizeof( Header ) );
+#define SECTION( s, p, n, T ) \
+  data[s] = ( p ); \
+  h.sections[s].offset = offset; \
+  h.sections[s].count = ( n ); \
+  h.sections[s].record = sizeof( T ); \
+  offset = Align( offset + h.sections[s].count * sizeof( T ) );
+  SECTION( SEC_CORES, _cores.data( ), _cores.size( ), CoreRange );
+  SECTION( SEC_WORKLOADS, _workloads.data( ), _workloads.size( ), Workload );
+  SECTION( SEC_OFMAPS, _ofmaps.data( ), _ofmaps.size( ), Ofmap );
+  SECTION( SEC_DESTS, _dests.data( ), _dests.size( ), Dest );
+  SECTION( SEC_BUFFERS, _buffers.data( ), _buffers.size( ), Buffer );
+  SECTION( SEC_SOURCES, _sources.data( ), _sources.size( ), Source );
+  SECTION( SEC_TRANSFERS, _transfers.data( ), _transfers.size( ), int );
+  SECTION( SEC_DDR_INS, _ddr_ins.data( ), _ddr_ins.size( ), DdrIn );
+  SECTION( SEC_DDR_OUTS, _ddr_outs.data( ), _ddr_outs.size( ), DdrOut );
+  SECTION( SEC_DDR_IDS, _ddr_ids.data( ), _ddr_ids.size( ), int );
+  SECTION( SEC_LAYER_OFFSETS, &offsets[0], offsets.size( ), uint64_t );
+  SECTION( SEC_LAYER_CHARS, chars.data( ), chars.size( ), char );
+#undef SECTION
+
+  ofstream out( file.c_str( ), ios::binary | ios::trunc );
+  if ( !out ) {
+    error = "cannot create " + file;
+    return false;
+  }
+  static const char pad[8] = { 0 };
+  out.write( reinterpret_cast<const char *>( &h ), sizeof( h ) );
+  uint64_t written = sizeof( h );
+  for ( int s = 0; s < NUM_SECTIONS; ++s ) {
+    out.write( pad, h.sections[s].offset - written );
+    out.write( static_cast<const char *>( data[s] ), h.sections[s].count * h.sections[s].record );
+    written = h.sections[s].offset + h.sections[s].count * h.sections[s].record;
+  }
+  if ( !out.flush( ) ) {
+    error = "cannot write " + file;
+    return false;
+  }
+  return true;
+}
+
+void WorkloadIR::InternLayers( int ( *intern )( const string & name ) )
+{
+  _flit_layers.resize( NumLayers( ) );
+  for ( int l = 0; l < NumLayers( ); ++l ) {
+    _flit_layers[l] = intern( _layer_names[l] );
+  }
+}
+
+int WorkloadIR::_InternLayer( const string & name )
+{
+  unordered_map<string, int>::const_iterator iter = _layer_ids.find( name );
+  if ( iter != _layer_ids.end( ) ) {
+    return iter->second;
+  }
+  int const layer = _layer_names.size( );
+  _layer_names.push_back( name );
+  _layer_ids[name] = layer;
+  return layer;
+}
+
+void WorkloadIR::_BeginCore( int core )
+{
+  assert( core >= 0 );
+  if ( core >= NumCores( ) ) {
+    CoreRange const empty = { 0, 0 };
+    _cores.resize( core + 1, empty );
+  }
+  _cores[core].begin = _workloads.size( );
+}
+
+void WorkloadIR::_EndCore( int core )
+{
+  _cores[core].end = _workloads.size( );
+}
+
+void WorkloadIR::_CompileWorkload( const nlohmann::json & w )
+{
+  Workload wl;
+  wl.workload_id = w["workload_id"].get<int>( );
+  wl.time = w["time"].get<int>( );
+  wl.ofmap_size = w["ofmap_size"].get<int>( );
+  wl.layer = _InternLayer( w["layer_name"].get<string>( ) );
+  wl.batch = 0;
+  if ( w.count( "workload" ) ) {
+    wl.batch = w["workload"][1][0].get<int>( ) - w["workload"][0][0].get<int>( ) + 1;
+  }
+
+  wl.ofmap_begin = _ofmaps.size( );
+  for ( auto & x : w["ofmap"] ) {
+    Ofmap o;
+    o.transfer_id = x["transfer_id"].get<int>( );
+    o.size = x.value( "size", 0 );
+    o.dest_begin = _dests.size( );
+    for ( auto & y : x["destination"] ) {
+      Dest d;
+      d.dram = ( y["type"].get<string>( ) == "DRAM" );
+      d.id = d.dram ? -1 : y["id"].get<int>( );
+      _dests.push_back( d );
+    }
+    o.dest_end = _dests.size( );
+    _ofmaps.push_back( o );
+  }
+  wl.ofmap_end = _ofmaps.size( );
+
+  wl.buffer_begin = _buffers.size( );
+  for ( auto & x : w["buffer"] ) {
+    if ( ( x["type"].get<string>( ) == "ofmap" ) || !x["newly_added"].get<bool>( ) ) {
+      continue;
+    }
+    Buffer b;
+    b.layer = _InternLayer( x["layer"].get<string>( ) );
+    b.source_begin = _sources.size( );
+    for ( auto & y : x["source"] ) {
+      Source s;
+      s.transfer_id = y["transfer_id"].get<int>( );
+      s.id = y["id"].get<int>( );
+      s.size = y.value( "size", 0 );
+      s.dram = ( y["type"].get<string>( ) == "DRAM" );
+      _sources.push_back( s );
+    }
+    b.source_end = _sources.size( );
+    _buffers.push_back( b );
+  }
+  wl.buffer_end = _buffers.size( );
+
+  wl.ifmap_begin = _transfers.size( );
+  for ( auto & x : w["ifmap"]["transfer_id"] ) {
+    _transfers.push_back( x.get<int>( ) );
+  }
+  wl.weight_begin = _transfers.size( );
+  if ( w.count( "weight" ) ) {
+    for ( auto & x : w["weight"]["transfer_id"] ) {
+      _transfers.push_back( x.get<int>( ) );
+    }
+  }
+  wl.weight_end = _transfers.size( );
+
+  _workloads.push_back( wl );
+}
+
+void WorkloadIR::_CompileDdrIn( const nlohmann::json & x )
+{
+  DdrIn in;
+  in.transfer_id = x["transfer_id"].get<int>( );
+  in.related_begin = _ddr_ids.size( );
+  for ( auto & y : x["related_ofmap"] ) {
+    _ddr_ids.push_back( y.get<int>( ) );
+  }
+  in.related_end = _ddr_ids.size( );
+  _ddr_ins.push_back( in );
+}
+
+void WorkloadIR::_CompileDdrOut( const nlohmann::json & x )
+{
+  DdrOut out;
+  out.transfer_id = x["transfer_id"].get<int>( );
+  out.related_ifmaps = x["related_ifmap"].size( );
+  out.size = x["size"].get<int>( );
+  out.layer = _InternLayer( x["layer_name"].get<string>( ) );
+  out.dest_begin = _ddr_ids.size( );
+  for ( auto & y : x["destination"] ) {
+    _ddr_ids.push_back( y["id"].get<int>( ) );
+  }
+  out.dest_end = _ddr_ids.size( );
+  _ddr_outs.push_back( out );
+}
+
+size_t WorkloadIR::Bytes( ) const
+{
+  size_t bytes = _cores.size( ) * sizeof( CoreRange ) +
+    _workloads.size( ) * sizeof( Workload ) +
+    _ofmaps.size( ) * sizeof( Ofmap ) +
+    _dests.size( ) * sizeof( Dest ) +
+    _buffers.size( ) * sizeof( Buffer ) +
+    _sources.size( ) * sizeof( Source ) +
+    _transfers.size( ) * sizeof( int ) +
+    _ddr_ins.size( ) * sizeof( DdrIn ) +
+    _ddr_outs.size( ) * sizeof( DdrOut ) +
+    _ddr_ids.size( ) * sizeof( int );
+  for ( size_t l = 0; l < _layer_names.size( ); ++l ) {
+    bytes += _layer_names[l].size( ) + 1;
+  }
+  return bytes;
+}
@@ -0,0 +1,246 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*workload_ir.hpp
+ *
+ *The workload IR compiled into flat typed arrays. Core and DDR only read
+ *these records, indexing plain arrays instead of looking up string keys.
+ *
+ *Two sources are accepted. The JSON schedule is streamed with a SAX
+ *reader that only ever holds one workload (or one DDR entry) as a DOM.
+ *The binary form written by Save (and booksim-ir-convert) holds the very
+ *same arrays and is mapped read-only, so the records are used in place:
+ *a core only faults in the pages of its own workloads, and processes
+ *mapping the same file share them.
+ *
+ *Records of all cores live in shared arrays, each core's workloads
+ *being one contiguous run. A workload names its ofmap transfers, newly
+ *added buffer entries and ifmap/weight transfer ids as [begin, end)
+ *ranges of the other arrays. Layer names are interned to small ids.
+ *
+ *The "-1" section of the IR describes what the DDRs serve: "in"
+ *transfers with the ofmaps they release and "out" transfers with their
+ *destinations.
+ */
+
+#ifndef _WORKLOAD_IR_HPP_
+#define _WORKLOAD_IR_HPP_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cassert>
+#include <cstddef>
+
+#include "json.hpp"
+
+using namespace std;
+
+class WorkloadIR {
+
+public:
+  // all records are made of ints only so that the binary file can be
+  // used without any conversion
+  struct Dest {
+    int id;		// -1 for DRAM
+    int dram;
+  };
+
+  struct Ofmap {
+    int transfer_id;
+    int size;
+    int dest_begin;
+    int dest_end;
+  };
+
+  struct Source {
+    int transfer_id;
+    int id;
+    int size;
+    int dram;
+  };
+
+  // newly added, non-ofmap buffer entry; the others are never consulted
+  struct Buffer {
+    int layer;
+    int source_begin;
+    int source_end;
+  };
+
+  struct Workload {
+    int workload_id;
+    int time;
+    int ofmap_size;
+    int layer;
+    int batch;
+    int ofmap_begin;
+    int ofmap_end;
+    int buffer_begin;
+    int buffer_end;
+    // ifmap transfers are [ifmap_begin, weight_begin), weight transfers
+    // [weight_begin, weight_end)
+    int ifmap_begin;
+    int weight_begin;
+    int weight_end;
+  };
+
+  struct DdrIn {
+    int transfer_id;
+    int related_begin;	// related ofmaps in the DDR id list
+    int related_end;
+  };
+
+  struct DdrOut {
+    int transfer_id;
+    int related_ifmaps;
+    int size;
+    int layer;
+    int dest_begin;	// destination cores in the DDR id list
+    int dest_end;
+  };
+
+  struct CoreRange {
+    int begin;
+    int end;
+  };
+
+  WorkloadIR( );
+  ~WorkloadIR( );
+
+  // reads a binary IR (recognized by its magic) or streams a JSON one;
+  // on failure returns false with the reason in error
+  bool Load( const string & file, string & error );
+  // writes the binary form
+  bool Save( const string & file, string & error ) const;
+  void Clear( );
+
+  // fills FlitLayer with intern( name ) for every layer
+  void InternLayers( int ( *intern )( const string & name ) );
+
+  // true if the records are read from a mapped binary file
+  bool Mapped( ) const { return _map != 0; }
+
+  // one past the largest core id in the schedule
+  int NumCores( ) const { return _cores.size( ); }
+  int TotalWorkloads( ) const { return _workloads.size( ); }
+  int NumWorkloads( int core ) const
+  {
+    if ( ( core < 0 ) || ( core >= NumCores( ) ) )
+      return 0;
+    return _cores[core].end - _cores[core].begin;
+  }
+  // the workloads of one core, in schedule order
+  const Workload * Workloads( int core ) const
+  {
+    if ( NumWorkloads( core ) == 0 )
+      return 0;
+    return &_workloads[_cores[core].begin];
+  }
+
+  const Ofmap & GetOfmap( int i ) const { return _ofmaps[i]; }
+  const Dest & GetDest( int i ) const { return _dests[i]; }
+  const Buffer & GetBuffer( int i ) const { return _buffers[i]; }
+  const Source & GetSource( int i ) const { return _sources[i]; }
+  int GetTransfer( int i ) const { return _transfers[i]; }
+
+  int NumDdrIns( ) const { return _ddr_ins.size( ); }
+  int NumDdrOuts( ) const { return _ddr_outs.size( ); }
+  const DdrIn & GetDdrIn( int i ) const { return _ddr_ins[i]; }
+  const DdrOut & GetDdrOut( int i ) const { return _ddr_outs[i]; }
+  int GetDdrId( int i ) const { return _ddr_ids[i]; }
+
+  int NumLayers( ) const { return _layer_names.size( ); }
+  const string & LayerName( int layer ) const { return _layer_names[layer]; }
+  // the id InternLayers got for the same name
+  int FlitLayer( int layer ) const { return _flit_layers[layer]; }
+
+  // bytes held by the compiled records
+  size_t Bytes( ) const;
+
+private:
+  friend class IRSaxReader;
+
+  // records filled by the JSON reader, or a view into the mapped file
+  template <class T>
+  class Table {
+  public:
+    Table( ) : _data( 0 ), _size( 0 ) { }
+    const T & operator[]( size_t i ) const { assert( i < _size ); return _data[i]; }
+    size_t size( ) const { return _size; }
+    const T * data( ) const { return _data; }
+    void push_back( const T & t )
+    {
+      _own.push_back( t );
+      _data = &_own[0];
+      _size = _own.size( );
+    }
+    void view( const T * data, size_t size )
+    {
+      _own.clear( );
+      _data = data;
+      _size = size;
+    }
+    void clear( ) { view( 0, 0 ); }
+  private:
+    vector<T> _own;
+    const T * _data;
+    size_t _size;
+  };
+
+  // cores may appear in any order in the file
+  vector<CoreRange> _cores;
+  Table<Workload> _workloads;
+  Table<Ofmap> _ofmaps;
+  Table<Dest> _dests;
+  Table<Buffer> _buffers;
+  Table<Source> _sources;
+  Table<int> _transfers;
+
+  Table<DdrIn> _ddr_ins;
+  Table<DdrOut> _ddr_outs;
+  Table<int> _ddr_ids;
+
+  vector<string> _layer_names;
+  vector<int> _flit_layers;
+  unordered_map<string, int> _layer_ids;
+
+  void * _map;
+  size_t _map_size;
+
+  bool _Parse( istream & in, string & error );
+  bool _Map( const string & file, string & error );
+
+  int _InternLayer( const string & name );
+  void _BeginCore( int core );
+  void _EndCore( int core );
+  void _CompileWorkload( const nlohmann::json & w );
+  void _CompileDdrIn( const nlohmann::json & x );
+  void _CompileDdrOut( const nlohmann::json & x );
+};
+
+#endif